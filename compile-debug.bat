@@ -1,30 +1,42 @@
 g++ -g -c core/utility.cpp
 g++ -g -c core/QQplotGenerator.cpp
 g++ -g -c core/shell.cpp
+g++ -g -c core/sparse.cpp
+g++ -g -c core/simd.cpp
+g++ -g -c core/threadpool.cpp
 
 g++ -g -c flowsolver/flowsolverbase.cpp
 g++ -g -c flowsolver/acosolver.cpp
 g++ -g -c flowsolver/immunesolver.cpp
 g++ -g -c flowsolver/ffsolver.cpp
+g++ -g -c flowsolver/electricalsolver.cpp
 
 g++ -g -c network/topology.cpp
 g++ -g -c network/network.cpp
+g++ -g -c network/reduction.cpp
+g++ -g -c network/distance.cpp
 
 g++ -g -c main.cpp
-g++ -g -o networkanalysis.exe utility.o QQplotGenerator.o shell.o topology.o network.o flowsolverbase.o acosolver.o immunesolver.o ffsolver.o main.o
+g++ -g -o networkanalysis.exe utility.o QQplotGenerator.o shell.o sparse.o simd.o threadpool.o topology.o network.o reduction.o distance.o flowsolverbase.o acosolver.o immunesolver.o ffsolver.o electricalsolver.o main.o
 
 move main.o bin/debug/main.o
 
 move network.o bin/debug/network.o
 move topology.o bin/debug/topology.o
+move reduction.o bin/debug/reduction.o
+move distance.o bin/debug/distance.o
 
 move utility.o bin/debug/utility.o
 move QQplotGenerator.o bin/debug/QQplotGenerator.o
 move shell.o bin/debug/shell.o
+move sparse.o bin/debug/sparse.o
+move simd.o bin/debug/simd.o
+move threadpool.o bin/debug/threadpool.o
 
 move flowsolverbase.o bin/debug/flowsolverbase.o
 move immunesolver.o bin/debug/immunesolver.o
 move ffsolver.o bin/debug/ffsolver.o
 move acosolver.o bin/debug/acosolver.o
+move electricalsolver.o bin/debug/electricalsolver.o
 
 move networkanalysis.exe bin/debug/networkanalysis.exe
\ No newline at end of file
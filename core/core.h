@@ -8,6 +8,9 @@
 #include "random.hpp"
 #include "utility.h"
 #include "shell.h"
+#include "sparse.h"
+#include "simd.h"
+#include "threadpool.h"
 
 #include "QQplotGenerator.h"
 
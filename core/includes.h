@@ -4,6 +4,7 @@
 
 #include <string>
 #include <sstream>
+#include <cstring>
 #include <random>
 #include <vector>
 #include <cmath>
@@ -22,6 +23,11 @@
 #include <queue>
 #include <limits>
 #include <tuple>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
 
 using namespace std;
 using namespace std::chrono;
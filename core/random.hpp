@@ -16,6 +16,15 @@ namespace core
         {
         }
 
+        RandomNumberGenerator(unsigned int seed) : m_generator(seed)
+        {
+        }
+
+        inline void seed(unsigned int seed)
+        {
+            m_generator.seed(seed);
+        }
+
         inline std::mt19937 &generator()
         {
             return m_generator;
@@ -298,6 +307,55 @@ namespace core
 	return max_index;*/
     }
 
+    //tabella alias di Walker (metodo di Vose): dopo una costruzione O(n) ogni estrazione costa O(1).
+    //small e large sono buffer di appoggio di almeno n elementi. Ritorna la somma dei pesi.
+    inline double buildAliasTable(const double *weights, int n, double *prob, int *alias, int *small, int *large)
+    {
+        double sum = 0;
+        for (int i = 0; i < n; i++)
+            sum += weights[i];
+        if (sum <= 0)
+            return 0;
+
+        int count_small = 0, count_large = 0;
+        for (int i = 0; i < n; i++)
+        {
+            prob[i] = weights[i] * n / sum;
+            alias[i] = i;
+            if (prob[i] < 1.0)
+                small[count_small++] = i;
+            else
+                large[count_large++] = i;
+        }
+
+        while (count_small > 0 && count_large > 0)
+        {
+            int l = small[--count_small];
+            int g = large[count_large - 1];
+            alias[l] = g;
+            prob[g] = (prob[g] + prob[l]) - 1.0;
+            if (prob[g] < 1.0)
+            {
+                count_large--;
+                small[count_small++] = g;
+            }
+        }
+
+        //i residui sono 1 a meno degli errori di arrotondamento
+        while (count_large > 0)
+            prob[large[--count_large]] = 1.0;
+        while (count_small > 0)
+            prob[small[--count_small]] = 1.0;
+        return sum;
+    }
+
+    inline int sampleAliasTable(const double *prob, const int *alias, int n, RandomNumberGenerator &random)
+    {
+        double u = random.getDouble({0.0, (double)n});
+        int i = min((int)u, n - 1);
+        return (u - i) < prob[i] ? i : alias[i];
+    }
+
     template <typename T>
     void swap(T *x1, T *x2)
     {
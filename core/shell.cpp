@@ -285,6 +285,7 @@ ShellCommandResult Shell::invokeInternal(string &command, shell_executive_state
             function_argument.output = _output;
             function_argument.state = state;
             function_argument.context = _context;
+            function_argument.optset = &_optset;
             return _commands[name](this, function_argument);
         }
         else
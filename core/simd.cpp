@@ -0,0 +1,322 @@
+#include "simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMD_X86
+#endif
+
+using namespace core;
+
+typedef struct s_simd_kernels
+{
+    void (*fill)(double *v, int n, double value);
+    double (*sum)(const double *v, int n);
+    double (*min)(const double *v, int n);
+    double (*dot)(const double *a, const double *b, int n);
+    void (*evaporate)(double *tau, const int *visited, const int *counters, int n, int epoch, double evaporation, double deposit);
+} simd_kernels;
+
+//kernel scalari
+
+void fillScalar(double *v, int n, double value)
+{
+    for (int i = 0; i < n; i++)
+        v[i] = value;
+}
+
+double sumScalar(const double *v, int n)
+{
+    double s = 0;
+    for (int i = 0; i < n; i++)
+        s += v[i];
+    return s;
+}
+
+double minScalar(const double *v, int n)
+{
+    double m = INFINITY;
+    for (int i = 0; i < n; i++)
+        m = v[i] < m ? v[i] : m;
+    return m;
+}
+
+double dotScalar(const double *a, const double *b, int n)
+{
+    double s = 0;
+    for (int i = 0; i < n; i++)
+        s += a[i] * b[i];
+    return s;
+}
+
+void evaporateScalar(double *tau, const int *visited, const int *counters, int n, int epoch, double evaporation, double deposit)
+{
+    for (int i = 0; i < n; i++)
+    {
+        double delta = visited[i] == epoch ? deposit / (double)counters[i] : 0.0;
+        tau[i] = evaporation * tau[i] + delta;
+    }
+}
+
+#ifdef SIMD_X86
+//kernel AVX2
+
+#define SIMD_AVX2_TARGET __attribute__((target("avx2,fma")))
+
+SIMD_AVX2_TARGET inline double horizontalSum(__m256d v)
+{
+    __m128d low = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+SIMD_AVX2_TARGET void fillAvx2(double *v, int n, double value)
+{
+    __m256d x = _mm256_set1_pd(value);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(v + i, x);
+    for (; i < n; i++)
+        v[i] = value;
+}
+
+SIMD_AVX2_TARGET double sumAvx2(const double *v, int n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(v + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(v + i + 4));
+    }
+    double s = horizontalSum(_mm256_add_pd(acc0, acc1));
+    for (; i < n; i++)
+        s += v[i];
+    return s;
+}
+
+SIMD_AVX2_TARGET double minAvx2(const double *v, int n)
+{
+    __m256d acc = _mm256_set1_pd(INFINITY);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_min_pd(acc, _mm256_loadu_pd(v + i));
+    __m128d low = _mm_min_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double m = _mm_cvtsd_f64(_mm_min_sd(low, _mm_unpackhi_pd(low, low)));
+    for (; i < n; i++)
+        m = v[i] < m ? v[i] : m;
+    return m;
+}
+
+SIMD_AVX2_TARGET double dotAvx2(const double *a, const double *b, int n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    double s = horizontalSum(_mm256_add_pd(acc0, acc1));
+    for (; i < n; i++)
+        s += a[i] * b[i];
+    return s;
+}
+
+SIMD_AVX2_TARGET void evaporateAvx2(double *tau, const int *visited, const int *counters, int n, int epoch, double evaporation, double deposit)
+{
+    __m256d e = _mm256_set1_pd(evaporation);
+    __m256d d = _mm256_set1_pd(deposit);
+    __m128i ep = _mm_set1_epi32(epoch);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        //maschera a 32 bit estesa a 64 bit per selezionare il deposito
+        __m128i hit = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(visited + i)), ep);
+        __m256d mask = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(hit));
+        __m256d c = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(counters + i)));
+        __m256d delta = _mm256_and_pd(mask, _mm256_div_pd(d, c));
+        _mm256_storeu_pd(tau + i, _mm256_fmadd_pd(e, _mm256_loadu_pd(tau + i), delta));
+    }
+    evaporateScalar(tau + i, visited + i, counters + i, n - i, epoch, evaporation, deposit);
+}
+
+//kernel AVX-512
+
+#define SIMD_AVX512_TARGET __attribute__((target("avx512f")))
+
+//le riduzioni e le conversioni non mascherate di GCC partono da un registro indefinito,
+//le varianti mascherate con sorgente esplicita danno lo stesso codice senza avvisi
+SIMD_AVX512_TARGET inline __m256d lowerHalf(__m512d v)
+{
+    return _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 0);
+}
+
+SIMD_AVX512_TARGET inline __m256d upperHalf(__m512d v)
+{
+    return _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 1);
+}
+
+SIMD_AVX512_TARGET inline double horizontalSum512(__m512d v)
+{
+    __m256d half = _mm256_add_pd(lowerHalf(v), upperHalf(v));
+    __m128d low = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+SIMD_AVX512_TARGET inline double horizontalMin512(__m512d v)
+{
+    __m256d half = _mm256_min_pd(lowerHalf(v), upperHalf(v));
+    __m128d low = _mm_min_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+SIMD_AVX512_TARGET void fillAvx512(double *v, int n, double value)
+{
+    __m512d x = _mm512_set1_pd(value);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(v + i, x);
+    for (; i < n; i++)
+        v[i] = value;
+}
+
+SIMD_AVX512_TARGET double sumAvx512(const double *v, int n)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(v + i));
+        acc1 = _mm512_add_pd(acc1, _mm512_loadu_pd(v + i + 8));
+    }
+    double s = horizontalSum512(_mm512_add_pd(acc0, acc1));
+    for (; i < n; i++)
+        s += v[i];
+    return s;
+}
+
+SIMD_AVX512_TARGET double minAvx512(const double *v, int n)
+{
+    __m512d acc = _mm512_set1_pd(INFINITY);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        acc = _mm512_mask_min_pd(acc, 0xFF, acc, _mm512_loadu_pd(v + i));
+    double m = horizontalMin512(acc);
+    for (; i < n; i++)
+        m = v[i] < m ? v[i] : m;
+    return m;
+}
+
+SIMD_AVX512_TARGET double dotAvx512(const double *a, const double *b, int n)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), acc1);
+    }
+    double s = horizontalSum512(_mm512_add_pd(acc0, acc1));
+    for (; i < n; i++)
+        s += a[i] * b[i];
+    return s;
+}
+
+SIMD_AVX512_TARGET void evaporateAvx512(double *tau, const int *visited, const int *counters, int n, int epoch, double evaporation, double deposit)
+{
+    __m512d e = _mm512_set1_pd(evaporation);
+    __m512d d = _mm512_set1_pd(deposit);
+    __m512i ep = _mm512_set1_epi64(epoch);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512i v = _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256((const __m256i *)(visited + i)));
+        __mmask8 hit = _mm512_cmpeq_epi64_mask(v, ep);
+        __m512d c = _mm512_maskz_cvtepi32_pd(0xFF, _mm256_loadu_si256((const __m256i *)(counters + i)));
+        __m512d delta = _mm512_maskz_div_pd(hit, d, c);
+        _mm512_storeu_pd(tau + i, _mm512_fmadd_pd(e, _mm512_loadu_pd(tau + i), delta));
+    }
+    evaporateScalar(tau + i, visited + i, counters + i, n - i, epoch, evaporation, deposit);
+}
+#endif
+
+simd_level core::detectSimdLevel()
+{
+#ifdef SIMD_X86
+    //puo' essere chiamata durante l'inizializzazione statica
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SIMD_AVX2;
+#endif
+    return SIMD_SCALAR;
+}
+
+simd_kernels createKernels(simd_level level)
+{
+    simd_kernels k = {fillScalar, sumScalar, minScalar, dotScalar, evaporateScalar};
+#ifdef SIMD_X86
+    if (level == SIMD_AVX2)
+        k = {fillAvx2, sumAvx2, minAvx2, dotAvx2, evaporateAvx2};
+    else if (level == SIMD_AVX512)
+        k = {fillAvx512, sumAvx512, minAvx512, dotAvx512, evaporateAvx512};
+#endif
+    return k;
+}
+
+static simd_level current_level = detectSimdLevel();
+static simd_kernels kernels = createKernels(current_level);
+
+simd_level core::getSimdLevel()
+{
+    return current_level;
+}
+
+void core::setSimdLevel(simd_level level)
+{
+    simd_level detected = detectSimdLevel();
+    current_level = level < detected ? level : detected;
+    kernels = createKernels(current_level);
+}
+
+string core::simdLevelName(simd_level level)
+{
+    switch (level)
+    {
+    case SIMD_AVX512:
+        return "avx512";
+    case SIMD_AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void core::fillArray(double *v, int n, double value)
+{
+    kernels.fill(v, n, value);
+}
+
+double core::sumArray(const double *v, int n)
+{
+    return kernels.sum(v, n);
+}
+
+double core::minArray(const double *v, int n)
+{
+    return kernels.min(v, n);
+}
+
+double core::dotArray(const double *a, const double *b, int n)
+{
+    return kernels.dot(a, b, n);
+}
+
+void core::evaporateDeposit(double *tau, const int *visited, const int *counters, int n, int epoch, double evaporation, double deposit)
+{
+    kernels.evaporate(tau, visited, counters, n, epoch, evaporation, deposit);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#ifndef _H_SIMD
+#define _H_SIMD
+
+#include "includes.h"
+
+namespace core
+{
+    enum simd_level
+    {
+        SIMD_SCALAR = 0,
+        SIMD_AVX2 = 1,
+        SIMD_AVX512 = 2
+    };
+
+    //livello massimo supportato dalla cpu
+    simd_level detectSimdLevel();
+
+    //livello usato dai kernel, all'avvio e' quello rilevato. Non puo' superare detectSimdLevel()
+    simd_level getSimdLevel();
+
+    void setSimdLevel(simd_level level);
+
+    string simdLevelName(simd_level level);
+
+    void fillArray(double *v, int n, double value);
+
+    double sumArray(const double *v, int n);
+
+    //INFINITY se n == 0
+    double minArray(const double *v, int n);
+
+    double dotArray(const double *a, const double *b, int n);
+
+    //tau[i] = evaporation * tau[i] + (visited[i] == epoch ? deposit / counters[i] : 0)
+    void evaporateDeposit(double *tau, const int *visited, const int *counters, int n, int epoch, double evaporation, double deposit);
+}
+#endif
@@ -0,0 +1,140 @@
+#include "sparse.h"
+#include "simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SPARSE_X86
+#endif
+
+using namespace core;
+
+typedef void (*spmv_function)(const csr_matrix &matrix, const double *x, double *y);
+
+void spmvScalar(const csr_matrix &matrix, const double *x, double *y)
+{
+    const int *offsets = matrix.offsets.data();
+    const int *columns = matrix.columns.data();
+    const double *values = matrix.values.data();
+
+    for (int i = 0; i < matrix.rows; i++)
+    {
+        double sum = 0;
+        for (int j = offsets[i]; j < offsets[i + 1]; j++)
+            sum += values[j] * x[columns[j]];
+        y[i] = sum;
+    }
+}
+
+#ifdef SPARSE_X86
+__attribute__((target("avx2,fma"))) void spmvAvx2(const csr_matrix &matrix, const double *x, double *y)
+{
+    const int *offsets = matrix.offsets.data();
+    const int *columns = matrix.columns.data();
+    const double *values = matrix.values.data();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    for (int i = 0; i < matrix.rows; i++)
+    {
+        int j = offsets[i];
+        int end = offsets[i + 1];
+
+        //quattro elementi per volta, x viene letto con una gather sugli indici di colonna.
+        //La gather mascherata ha una sorgente esplicita, quella semplice parte da un registro indefinito
+        __m256d acc = _mm256_setzero_pd();
+        for (; j + 4 <= end; j += 4)
+        {
+            __m128i index = _mm_loadu_si128((const __m128i *)(columns + j));
+            __m256d xv = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, index, all, 8);
+            __m256d av = _mm256_loadu_pd(values + j);
+            acc = _mm256_fmadd_pd(av, xv, acc);
+        }
+
+        __m128d low = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        double sum = _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+        for (; j < end; j++)
+            sum += values[j] * x[columns[j]];
+        y[i] = sum;
+    }
+}
+#endif
+
+spmv_function selectSpmvKernel()
+{
+#ifdef SPARSE_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return spmvAvx2;
+#endif
+    return spmvScalar;
+}
+
+void core::spmv(const csr_matrix &matrix, const double *x, double *y)
+{
+    static spmv_function kernel = selectSpmvKernel();
+    kernel(matrix, x, y);
+}
+
+string core::spmvKernelName()
+{
+    return selectSpmvKernel() == spmvScalar ? "scalar" : "avx2";
+}
+
+int ConjugateGradient::solve(const csr_matrix &matrix, const double *b, double *x, double tolerance, int max_interations)
+{
+    int n = matrix.rows;
+    _r.resize(n);
+    _z.resize(n);
+    _p.resize(n);
+    _q.resize(n);
+    _inv_diagonal.resize(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        double d = 0;
+        for (int j = matrix.offsets[i]; j < matrix.offsets[i + 1]; j++)
+        {
+            if (matrix.columns[j] == i)
+                d = matrix.values[j];
+        }
+        _inv_diagonal[i] = d != 0 ? 1.0 / d : 1.0;
+    }
+
+    //x contiene la soluzione di partenza
+    spmv(matrix, x, _q.data());
+    for (int i = 0; i < n; i++)
+    {
+        _r[i] = b[i] - _q[i];
+        _z[i] = _r[i] * _inv_diagonal[i];
+        _p[i] = _z[i];
+    }
+
+    double norm_b = sqrt(dotArray(b, b, n));
+    if (norm_b == 0)
+        norm_b = 1;
+
+    double rz = dotArray(_r.data(), _z.data(), n);
+    int k = 0;
+    while (k < max_interations && sqrt(dotArray(_r.data(), _r.data(), n)) > tolerance * norm_b)
+    {
+        spmv(matrix, _p.data(), _q.data());
+        double pq = dotArray(_p.data(), _q.data(), n);
+        if (pq <= 0)
+            break;
+
+        double alfa = rz / pq;
+        for (int i = 0; i < n; i++)
+        {
+            x[i] += alfa * _p[i];
+            _r[i] -= alfa * _q[i];
+            _z[i] = _r[i] * _inv_diagonal[i];
+        }
+
+        double rz_next = dotArray(_r.data(), _z.data(), n);
+        double beta = rz_next / rz;
+        rz = rz_next;
+        for (int i = 0; i < n; i++)
+            _p[i] = _z[i] + beta * _p[i];
+
+        k++;
+    }
+    return k;
+}
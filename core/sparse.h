@@ -0,0 +1,42 @@
+#pragma once
+#ifndef _H_SPARSE
+#define _H_SPARSE
+
+#include "includes.h"
+
+namespace core
+{
+    //matrice sparsa in formato CSR: la riga i occupa [offsets[i], offsets[i + 1]) di columns e values
+    typedef struct s_csr_matrix
+    {
+        int rows = 0;
+        vector<int> offsets;
+        vector<int> columns;
+        vector<double> values;
+
+        inline int size() const
+        {
+            return columns.size();
+        }
+    } csr_matrix;
+
+    //y = A * x, il kernel AVX2 viene scelto a runtime se la cpu lo supporta
+    void spmv(const csr_matrix &matrix, const double *x, double *y);
+
+    string spmvKernelName();
+
+    //gradiente coniugato precondizionato (Jacobi) per matrici simmetriche definite positive
+    class ConjugateGradient
+    {
+    private:
+        vector<double> _r;
+        vector<double> _z;
+        vector<double> _p;
+        vector<double> _q;
+        vector<double> _inv_diagonal;
+
+    public:
+        int solve(const csr_matrix &matrix, const double *b, double *x, double tolerance, int max_interations);
+    };
+}
+#endif
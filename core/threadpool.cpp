@@ -0,0 +1,89 @@
+#include "threadpool.h"
+
+using namespace core;
+
+ThreadPool::ThreadPool(int count_threads)
+{
+    if (count_threads <= 0)
+        count_threads = max((int)thread::hardware_concurrency(), 1);
+
+    _job = nullptr;
+    _count_tasks = 0;
+    _generation = 0;
+    _running = 0;
+    _stop = false;
+
+    //il thread chiamante esegue il blocco 0
+    for (int i = 1; i < count_threads; i++)
+        _workers.push_back(thread(&ThreadPool::work, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        unique_lock<mutex> lock(_mutex);
+        _stop = true;
+    }
+    _start.notify_all();
+    for (auto &&worker : _workers)
+        worker.join();
+}
+
+void ThreadPool::runBlock(int index)
+{
+    int count_threads = size();
+    int begin = (int)((long)_count_tasks * index / count_threads);
+    int end = (int)((long)_count_tasks * (index + 1) / count_threads);
+    for (int task = begin; task < end; task++)
+        (*_job)(task, index);
+}
+
+void ThreadPool::work(int index)
+{
+    int generation = 0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(_mutex);
+            _start.wait(lock, [&]
+                        { return _stop || _generation != generation; });
+            if (_stop)
+                return;
+            generation = _generation;
+        }
+
+        runBlock(index);
+
+        {
+            unique_lock<mutex> lock(_mutex);
+            if (--_running == 0)
+                _done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::run(int count_tasks, const thread_pool_job &job)
+{
+    if (_workers.empty() || count_tasks <= 1)
+    {
+        for (int task = 0; task < count_tasks; task++)
+            job(task, 0);
+        return;
+    }
+
+    {
+        unique_lock<mutex> lock(_mutex);
+        _job = &job;
+        _count_tasks = count_tasks;
+        _running = _workers.size();
+        _generation++;
+    }
+    _start.notify_all();
+
+    runBlock(0);
+
+    unique_lock<mutex> lock(_mutex);
+    _done.wait(lock, [&]
+               { return _running == 0; });
+    _job = nullptr;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef _H_THREADPOOL
+#define _H_THREADPOOL
+
+#include "includes.h"
+
+namespace core
+{
+    //job(task, thread): thread e' l'indice del worker in [0, size()), utile per i buffer locali
+    typedef function<void(int, int)> thread_pool_job;
+
+    //pool di thread persistenti. run() divide i task in blocchi contigui, uno per thread,
+    //e ritorna quando tutti i blocchi sono completati: la partizione non dipende dai tempi
+    //di esecuzione, quindi ogni task viene sempre eseguito dallo stesso thread.
+    class ThreadPool
+    {
+    private:
+        vector<thread> _workers;
+        mutex _mutex;
+        condition_variable _start;
+        condition_variable _done;
+        const thread_pool_job *_job;
+        int _count_tasks;
+        int _generation;
+        int _running;
+        bool _stop;
+
+    public:
+        //count_threads <= 0 usa tutti i core disponibili
+        ThreadPool(int count_threads = 0);
+
+        ~ThreadPool();
+
+        inline int size() const
+        {
+            return _workers.size() + 1;
+        }
+
+        void run(int count_tasks, const thread_pool_job &job);
+
+    private:
+        void work(int index);
+
+        void runBlock(int index);
+    };
+}
+#endif
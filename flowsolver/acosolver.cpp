@@ -4,23 +4,120 @@ using namespace flowsolver;
 using namespace core;
 using namespace graph;
 
+void AcoHistory::reset(int count_edges, int period)
+{
+    _records.clear();
+    _last.assign(count_edges, 0.0);
+    _period = MAX(1, period);
+    _last_checkpoint = 0;
+    _best = -1;
+}
+
+int AcoHistory::record(network *network, bool best)
+{
+    network_index &index = network->getIndex();
+    int count_edges = _last.size();
+    int version = _records.size();
+    bool periodic = version == 0 || version - _last_checkpoint >= _period;
+
+    _records.push_back(aco_record());
+    aco_record &r = _records.back();
+    r.checkpoint = periodic || best;
+    if (r.checkpoint)
+    {
+        r.flows.resize(count_edges);
+        for (int e = 0; e < count_edges; e++)
+            r.flows[e] = _last[e] = index.edges[e]->flow;
+    }
+    else
+    {
+        for (int e = 0; e < count_edges; e++)
+        {
+            double flow = index.edges[e]->flow;
+            if (flow != _last[e])
+            {
+                r.edges.push_back(e);
+                r.values.push_back(flow);
+                _last[e] = flow;
+            }
+        }
+    }
+
+    //resta completa solo la copia dell'ultimo migliore, le precedenti tornano differenze
+    if (best)
+    {
+        if (_best >= 0)
+            demote(_best);
+        _best = periodic ? -1 : version;
+    }
+    if (periodic)
+        _last_checkpoint = version;
+    return version;
+}
+
+void AcoHistory::demote(int version)
+{
+    int count_edges = _last.size();
+    vector<double> previous(count_edges);
+    reconstruct(version - 1, previous.data());
+
+    aco_record &r = _records[version];
+    for (int e = 0; e < count_edges; e++)
+    {
+        if (r.flows[e] != previous[e])
+        {
+            r.edges.push_back(e);
+            r.values.push_back(r.flows[e]);
+        }
+    }
+    vector<double>().swap(r.flows);
+    r.checkpoint = false;
+}
+
+void AcoHistory::reconstruct(int version, double *flows)
+{
+    int k = version;
+    while (!_records[k].checkpoint)
+        k--;
+
+    copy(_records[k].flows.begin(), _records[k].flows.end(), flows);
+    for (k++; k <= version; k++)
+    {
+        aco_record &r = _records[k];
+        int n = r.edges.size();
+        for (int i = 0; i < n; i++)
+            flows[r.edges[i]] = r.values[i];
+    }
+}
+
+size_t AcoHistory::memory() const
+{
+    size_t bytes = 0;
+    for (auto &&r : _records)
+        bytes += r.flows.size() * sizeof(double) + r.edges.size() * sizeof(int) + r.values.size() * sizeof(double);
+    return bytes;
+}
+
 void AcoSolution::extract(network *network)
 {
     if (_flows != nullptr)
         delete[] _flows;
 
-    topology &edges = network->getTopology();
-    _count_edges = edges.size();
+    //l'indice della rete evita una ricerca nella mappa per ogni arco
+    _history = nullptr;
+    _count_edges = network->countEdges();
     _flows = new double[_count_edges];
     _max_flow = network->getFlow();
     for (int i = 0; i < _count_edges; i++)
-        _flows[i] = edges.get(i).flow;
+        _flows[i] = network->getEdge(i).flow;
 }
 
 string AcoSolution::toString(bool compact)
 {
+    vector<double> flows(_count_edges);
+    getFlows(flows.data());
     if (compact)
-        return to_string_format(_flows, _count_edges);
+        return to_string_format(flows.data(), _count_edges);
     else
     {
 
@@ -29,13 +126,16 @@ string AcoSolution::toString(bool compact)
            << "\t"
            << "Max flow: " << to_string_format(_max_flow) << endl
            << "\t"
-           << "Flows: " << to_string_format(_flows, _count_edges) << endl;
+           << "Flows: " << to_string_format(flows.data(), _count_edges) << endl;
         return ss.str();
     }
 }
 
 ACOSolver::ACOSolver(/* args */)
 {
+    _branching = 0;
+    _restarts = 0;
+    _quiet = false;
 }
 
 void ACOSolver::dispose()
@@ -47,57 +147,46 @@ void ACOSolver::dispose()
 void ACOSolver::reset()
 {
     this->internalReset();
+    _global_best.clear();
+    _branching = 0;
+    _restarts = 0;
 }
 
-network_node *selectNextNode(network *net, network_node *source, network_path &current_path, void *arg)
+//sceglie il passo di una formica. E' un funtore per permettere a navigate di inlinarlo
+struct aco_selector
 {
-    network_node *dest = nullptr;
-
-    ACOSolver *solver = (ACOSolver *)arg;
-    AcoOption &option = solver->getOption();
-    RandomNumberGenerator *random = solver->getRandomGenerator();
-    int current_size = current_path->size();
+    network *net;
+    aco_worker *worker;
 
-    //compute propability
-    int n = source->next.size();
-    if (n > 0)
+    inline network_node *operator()(network_node *source, int current_size)
     {
-        double *scores = new double[n];
-        double sum = 0;
-        for (int i = 0; i < n; i++)
-        {
-            network_node *node = source->next[i];
-            network_edge &e = net->getEdge({source->id, node->id});
-            if (!e.enable)
-            {
-                scores[i] = 0;
-            }
-            else if (IS_NODE_TARGET(node->id) && !e.isSaturated())
-            {
-                scores[i] = DBL_MAX;
-            }
-            else
-            {
-                //double distance_score = 1;
-                //if (node->distance_heuristic >= 0)
-                //{
-                //    distance_score = (node->distance_heuristic + current_size);
-                //}
-
-                scores[i] = pow(e.tau, option.alfa) * pow(e.getResidualCapacity(), option.beta1) / pow((double)e.counter, option.beta2);
-                //scores[i] = ((pow(e.tau, option.alfa) + 1.0) * pow(e.getResidualCapacity(), option.beta)) / exp((e.counter + 1.0) / option.gamma);
-                //scores[i] = (pow(e.tau, option.alfa) * pow(INVD(e.getResidualCapacity()), option.beta)) / (1.0 + (double)e.counter);
-            }
+        network_node *dest = nullptr;
 
-            sum += scores[i];
-        }
+        AcoOption &option = worker->solver->getOption();
+        aco_transitions &transitions = worker->solver->getTransitions();
+        network_index &index = net->getIndex();
 
-        if (sum > 0)
+        int u = GET_NODE_NORMAL_ID(source->id);
+        int target_edge = transitions.target_edges[u];
+        if (target_edge >= 0 && index.edges[target_edge]->enable && !index.edges[target_edge]->isSaturated())
         {
-            divAll<double>(scores, n, sum);
+            worker->hops.push_back(target_edge);
+            return net->getNode(ID_NODE_TARGET);
+        }
 
-            int next_node_index = random->argmax(scores, n, false);
-            dest = source->next.at(next_node_index);
+        int begin = transitions.slot_offsets[u];
+        int n = transitions.slot_offsets[u + 1] - begin;
+        if (n > 0 && transitions.sums[u] > 0)
+        {
+            //i nodi gia' nel cammino vengono riestratti qualche volta, poi il ciclo viene rimosso da navigate
+            int next_arc;
+            int attempt = 0;
+            do
+            {
+                next_arc = transitions.slots[begin + sampleAliasTable(&transitions.prob[begin], &transitions.alias[begin], n, worker->random)];
+            } while (attempt++ < ACO_TABU_RETRIES && worker->tabu.contains(transitions.heads[next_arc] - 2));
+            dest = net->getNode(transitions.heads[next_arc] - 2);
+            worker->hops.push_back(transitions.edges[next_arc]);
 
             if (option.advanced_log)
             {
@@ -106,177 +195,960 @@ network_node *selectNextNode(network *net, network_node *source, network_path &c
                    << "size: " << to_string_format(current_size) << endl;
                 for (int i = 0; i < n; i++)
                 {
-                    network_edgekey key(source->id, source->next[i]->id);
+                    int arc = transitions.slots[begin + i];
+                    network_edgekey key(source->id, transitions.heads[arc] - 2);
                     ss << "edge: " << to_string(key) << endl
-                       << "prob: " << to_string_format(scores[i]) << endl
+                       << "prob: " << to_string_format(transitions.attractiveness[arc] / transitions.sums[u]) << endl
                        << "distance: " << to_string_format(dest->distance_heuristic) << endl
-                       << "is choose: " << to_string_format(next_node_index == i) << endl
-                       << to_string(net->getEdge(key)) << endl;
+                       << "is choose: " << to_string_format(next_arc == arc) << endl
+                       << to_string(*index.edges[transitions.edges[arc]]) << endl;
                 }
                 cout << ss.str() << endl;
             }
         }
+        return dest;
+    }
+};
 
-        delete[] scores;
+void ACOSolver::buildTransitions()
+{
+    network_index &index = _network->getIndex();
+    int n = index.count_nodes;
+    int m = index.count_edges;
+
+    //archi inversi verso la sorgente non servono: la formica ci riparte gia'
+    int source = GET_NODE_NORMAL_ID(ID_NODE_SOURCE);
+    int max_degree = 0;
+    int max_slots = 0;
+    _transitions.offsets.assign(n + 1, 0);
+    _transitions.slot_offsets.assign(n + 1, 0);
+    _transitions.edges.clear();
+    _transitions.heads.clear();
+    _transitions.forward_arcs.assign(m, -1);
+    _transitions.backward_arcs.assign(m, -1);
+    for (int u = 0; u < n; u++)
+    {
+        for (int i = index.out_offsets[u]; i < index.out_offsets[u + 1]; i++)
+        {
+            _transitions.forward_arcs[index.out_edges[i]] = _transitions.edges.size();
+            _transitions.edges.push_back(index.out_edges[i]);
+            _transitions.heads.push_back(index.heads[index.out_edges[i]]);
+        }
+        if (_option.residual_graph)
+        {
+            for (int i = index.in_offsets[u]; i < index.in_offsets[u + 1]; i++)
+            {
+                int e = index.in_edges[i];
+                if (index.tails[e] == source || index.tails[e] == u)
+                    continue;
+                _transitions.backward_arcs[e] = _transitions.edges.size();
+                _transitions.edges.push_back(e);
+                _transitions.heads.push_back(index.tails[e]);
+            }
+        }
+        _transitions.offsets[u + 1] = _transitions.edges.size();
+        int degree = _transitions.offsets[u + 1] - _transitions.offsets[u];
+        int slots = _option.candidate_list > 0 ? MIN(degree, _option.candidate_list) : degree;
+        _transitions.slot_offsets[u + 1] = _transitions.slot_offsets[u] + slots;
+        max_degree = MAX(max_degree, degree);
+        max_slots = MAX(max_slots, slots);
+    }
+
+    //senza candidate_list ogni arco e' il posto di se stesso
+    int count_arcs = _transitions.edges.size();
+    int count_slots = _transitions.slot_offsets[n];
+    _transitions.attractiveness.assign(count_arcs, 0.0);
+    _transitions.slots.resize(count_slots);
+    _transitions.slot_of.assign(count_arcs, -1);
+    for (int u = 0; u < n; u++)
+    {
+        for (int i = 0; i < _transitions.slot_offsets[u + 1] - _transitions.slot_offsets[u]; i++)
+        {
+            _transitions.slots[_transitions.slot_offsets[u] + i] = _transitions.offsets[u] + i;
+            _transitions.slot_of[_transitions.offsets[u] + i] = _transitions.slot_offsets[u] + i;
+        }
+    }
+    _transitions.weights.assign(_option.candidate_list > 0 ? count_slots : 0, 0.0);
+    _transitions.changed.clear();
+    _transitions.rescan.assign(n, 1);
+    _transitions.order.resize(max_degree);
+    _transitions.prob.assign(count_slots, 0.0);
+    _transitions.alias.assign(count_slots, 0);
+    _transitions.sums.assign(n, 0.0);
+    _transitions.target_edges.assign(n, -1);
+    _transitions.dirty.assign(n, 1);
+    _transitions.small.resize(max_slots);
+    _transitions.large.resize(max_slots);
+
+    for (int i = 0; i < m; i++)
+    {
+        if (index.heads[i] == GET_NODE_NORMAL_ID(ID_NODE_TARGET))
+            _transitions.target_edges[index.tails[i]] = i;
     }
-    return dest;
 }
 
-void ACOSolver::solver()
+double ACOSolver::getAttractiveness(int u, int arc, int now)
 {
+    network_index &index = _network->getIndex();
+    int e = _transitions.edges[arc];
+    network_edge *edge = index.edges[e];
+    if (!edge->enable)
+        return 0;
 
-    if (this->_state != SOLVER_READY)
-        throw "state is not valid";
+    double residual = index.tails[e] == u ? edge->getResidualCapacity() : edge->flow;
+    double attractiveness = pow(getTau(e, now), _option.alfa) * pow(residual, _option.beta1) / pow((double)_pheromone.counters[e], _option.beta2);
 
-    this->_start_timestamp = GET_CURRENT_TIMESTAMP;
-    this->_state = SOLVER_COMPUTING;
+    //ogni arco che non si avvicina al target costa un fattore e^-beta3, un nodo da cui il
+    //target non e' raggiungibile non viene mai scelto
+    if (_option.beta3 > 0)
+    {
+        int head = _transitions.heads[arc];
+        if (!_distances.isReachable(head))
+            return 0;
+        attractiveness *= exp(-_option.beta3 * (_distances.getLabel(head) - _distances.getLabel(u) + 1));
+    }
+    return attractiveness;
+}
 
-    int max_size_path = this->_network->countEdges() * 0.6;
-    double flow_upperbound = this->_network->getFlowUpperbound();
-    int colony_size = this->_option.colony_size;
-    unordered_set<network_edgekey, network_edgekey_hasher> visited_edges;
+void ACOSolver::selectCandidates(int u, int now)
+{
+    int begin = _transitions.offsets[u];
+    int n = _transitions.offsets[u + 1] - begin;
+    int slot_begin = _transitions.slot_offsets[u];
+    int count_slots = _transitions.slot_offsets[u + 1] - slot_begin;
+    double *attractiveness = _transitions.attractiveness.data();
+    int *order = _transitions.order.data();
 
-    _network->reset(false, false, true, true, true, _option.pheromone / 2.0);
+    for (int i = 0; i < n; i++)
+    {
+        attractiveness[begin + i] = getAttractiveness(u, begin + i, now);
+        _transitions.slot_of[begin + i] = -1;
+        order[i] = begin + i;
+    }
+    if (count_slots < n)
+        nth_element(order, order + count_slots, order + n, [&](int a, int b)
+                    { return attractiveness[a] > attractiveness[b]; });
 
-    while (this->_current_interation < this->_option.max_interations &&
-           (this->_best_result == nullptr || this->_best_result->fitness < flow_upperbound))
+    for (int i = 0; i < count_slots; i++)
     {
-        statistic *stat = new statistic();
-        this->_statistics.push_back(stat);
+        _transitions.slots[slot_begin + i] = order[i];
+        _transitions.slot_of[order[i]] = slot_begin + i;
+        _transitions.weights[slot_begin + i] = attractiveness[order[i]];
+    }
+    _transitions.rescan[u] = 0;
+}
 
-        stat->start_timestamp = GET_CURRENT_TIMESTAMP;
+void ACOSolver::offerCandidate(int u, int arc, int now)
+{
+    if (arc < 0 || _transitions.rescan[u] || _transitions.slot_of[arc] >= 0)
+        return;
+
+    int slot_begin = _transitions.slot_offsets[u];
+    int slot_end = _transitions.slot_offsets[u + 1];
+    int weakest = slot_begin;
+    for (int s = slot_begin + 1; s < slot_end; s++)
+    {
+        if (_transitions.weights[s] < _transitions.weights[weakest])
+            weakest = s;
+    }
+
+    double attractiveness = getAttractiveness(u, arc, now);
+    _transitions.attractiveness[arc] = attractiveness;
+    if (attractiveness > _transitions.weights[weakest])
+    {
+        _transitions.slot_of[_transitions.slots[weakest]] = -1;
+        _transitions.slots[weakest] = arc;
+        _transitions.slot_of[arc] = weakest;
+        _transitions.weights[weakest] = attractiveness;
+    }
+}
 
-        network_path min_path = emptyPath;
-        //fa navigare una formica alla volta
-        for (int k = 0; k < colony_size; k++)
+void ACOSolver::updateTransitions(int now)
+{
+    network_index &index = _network->getIndex();
+    if (_option.candidate_list <= 0)
+    {
+        for (int u = 0; u < index.count_nodes; u++)
         {
-            //un ant naviga per la rete di flusso
-            network_path l = this->_network->navigate(selectNextNode, this, max_size_path);
-            int size_path = l->size();
-            for (int i = 0; i < size_path - 1; i++)
-            {
-                network_edgekey e = {l->at(i), l->at(i + 1)};
-                visited_edges.insert(e);
-            }
+            if (!_transitions.dirty[u])
+                continue;
 
-            //this->_network->updateHeuristicDistance(l);
+            int begin = _transitions.offsets[u];
+            int n = _transitions.offsets[u + 1] - begin;
+            for (int i = 0; i < n; i++)
+                _transitions.attractiveness[begin + i] = getAttractiveness(u, begin + i, now);
 
-            if (isValidPath(l))
-            {
-                if (!isValidPath(min_path) || size_path < min_path->size())
-                {
-                    min_path = l;
-                }
-                else
-                {
-                    deletePath(l);
-                }
-            }
-            else
+            _transitions.sums[u] = buildAliasTable(&_transitions.attractiveness[begin], n, &_transitions.prob[begin], &_transitions.alias[begin],
+                                                   _transitions.small.data(), _transitions.large.data());
+            _transitions.dirty[u] = 0;
+        }
+        return;
+    }
+
+    //prima si aggiornano i candidati dei nodi sporchi, poi gli archi cambiati fuori lista si
+    //confrontano con il candidato piu' debole: il costo per nodo e' O(candidate_list)
+    vector<int> &changed = _transitions.changed;
+    for (auto &&e : changed)
+    {
+        _transitions.dirty[index.tails[e]] = 1;
+        if (_transitions.backward_arcs[e] >= 0)
+            _transitions.dirty[index.heads[e]] = 1;
+    }
+    for (int u = 0; u < index.count_nodes; u++)
+    {
+        if (!_transitions.dirty[u] || _transitions.rescan[u])
+            continue;
+        for (int s = _transitions.slot_offsets[u]; s < _transitions.slot_offsets[u + 1]; s++)
+        {
+            _transitions.weights[s] = getAttractiveness(u, _transitions.slots[s], now);
+            _transitions.attractiveness[_transitions.slots[s]] = _transitions.weights[s];
+        }
+    }
+    for (auto &&e : changed)
+    {
+        offerCandidate(index.tails[e], _transitions.forward_arcs[e], now);
+        offerCandidate(index.heads[e], _transitions.backward_arcs[e], now);
+    }
+    changed.clear();
+
+    for (int u = 0; u < index.count_nodes; u++)
+    {
+        if (!_transitions.dirty[u])
+            continue;
+
+        int slot_begin = _transitions.slot_offsets[u];
+        int count_slots = _transitions.slot_offsets[u + 1] - slot_begin;
+        double *weights = &_transitions.weights[slot_begin];
+
+        //con i candidati tutti saturi o disabilitati si torna a guardare l'intero vicinato
+        if (!_transitions.rescan[u] && sumArray(weights, count_slots) <= 0)
+            _transitions.rescan[u] = 1;
+        if (_transitions.rescan[u])
+            selectCandidates(u, now);
+
+        _transitions.sums[u] = buildAliasTable(weights, count_slots, &_transitions.prob[slot_begin], &_transitions.alias[slot_begin],
+                                               _transitions.small.data(), _transitions.large.data());
+        _transitions.dirty[u] = 0;
+    }
+}
+
+void ACOSolver::updatePheromone(int epoch)
+{
+    double evaporation = 1 - _option.rho;
+    double deposit = (double)_option.colony_size * _option.pheromone;
+    double *tau = _pheromone.tau.data();
+    int *stamps = _pheromone.stamps.data();
+    const int *counters = _pheromone.counters.data();
+    const int *visited = _pheromone.visited.data();
+    const double *decay = _pheromone.decay.data();
+
+    if (_option.eager_evaporation)
+    {
+        //evaporazione e deposito in un unico passaggio lineare sugli array
+        int count_edges = _pheromone.tau.size();
+        evaporateDeposit(tau, visited, counters, count_edges, epoch, evaporation, deposit);
+        fill(stamps, stamps + count_edges, epoch);
+    }
+    else
+    {
+        //gli archi non attraversati evaporano alla lettura
+        for (auto &&e : _pheromone.touched)
+        {
+            tau[e] = decay[epoch - stamps[e]] * tau[e] + deposit / (double)counters[e];
+            stamps[e] = epoch;
+        }
+    }
+    _pheromone.touched.clear();
+}
+
+void ACOSolver::updatePheromoneMMAS(int epoch, const int *path, int size)
+{
+    double *tau = _pheromone.tau.data();
+    int *stamps = _pheromone.stamps.data();
+
+    if (_option.eager_evaporation)
+    {
+        int count_edges = _pheromone.tau.size();
+        for (int e = 0; e < count_edges; e++)
+        {
+            tau[e] = getTau(e, epoch);
+            stamps[e] = epoch;
+        }
+    }
+
+    //deposita solo la formica scelta, in proporzione all'inverso della lunghezza
+    double deposit = _option.pheromone / (double)size;
+    for (int i = 0; i < size - 1; i++)
+    {
+        int e = findArc(GET_NODE_NORMAL_ID(path[i]), GET_NODE_NORMAL_ID(path[i + 1]));
+        if (e < 0)
+            continue;
+        tau[e] = MIN(getTau(e, epoch) + deposit, _pheromone.tau_max);
+        stamps[e] = epoch;
+        if (_option.candidate_list > 0)
+            _transitions.changed.push_back(e);
+    }
+    _pheromone.touched.clear();
+}
+
+void ACOSolver::updateBounds(int size)
+{
+    network_index &index = _network->getIndex();
+
+    //tau_max e' il valore di equilibrio del deposito del cammino migliore, tau_min fa si' che a
+    //convergenza il cammino migliore venga ricostruito con probabilita' mmas_pbest
+    _pheromone.tau_max = _option.pheromone / ((double)size * _option.rho);
+    double root = pow(_option.mmas_pbest, 1.0 / (double)size);
+    double avg = index.count_nodes > 0 ? (double)index.count_edges / (double)index.count_nodes : 0;
+    if (avg > 1)
+        _pheromone.tau_min = _pheromone.tau_max * (1 - root) / ((avg - 1) * root);
+    else
+        _pheromone.tau_min = _pheromone.tau_max / (2.0 * size);
+    _pheromone.tau_min = MIN(_pheromone.tau_min, _pheromone.tau_max);
+}
+
+double ACOSolver::computeBranching(int now)
+{
+    network_index &index = _network->getIndex();
+    int count_nodes = 0;
+    int count_branches = 0;
+    for (int u = 0; u < index.count_nodes; u++)
+    {
+        double low = INFINITY, high = 0;
+        for (int i = _transitions.offsets[u]; i < _transitions.offsets[u + 1]; i++)
+        {
+            int e = _transitions.edges[i];
+            if (!index.edges[e]->enable)
+                continue;
+            double tau = getTau(e, now);
+            low = MIN(low, tau);
+            high = MAX(high, tau);
+        }
+
+        //i nodi con tutti gli archi uguali non sono ancora stati esplorati
+        if (!(high > low))
+            continue;
+
+        double threshold = low + _option.mmas_lambda * (high - low);
+        for (int i = _transitions.offsets[u]; i < _transitions.offsets[u + 1]; i++)
+        {
+            int e = _transitions.edges[i];
+            if (index.edges[e]->enable && getTau(e, now) >= threshold)
+                count_branches++;
+        }
+        count_nodes++;
+    }
+
+    if (count_nodes == 0)
+        return index.count_nodes > 0 ? (double)_transitions.edges.size() / (double)index.count_nodes : 0;
+    return (double)count_branches / (double)count_nodes;
+}
+
+void ACOSolver::restartPheromone(int epoch)
+{
+    int count_edges = _pheromone.tau.size();
+    double value = isinf(_pheromone.tau_max) ? _option.pheromone / _option.rho : _pheromone.tau_max;
+    fillArray(_pheromone.tau.data(), count_edges, value);
+    fill(_pheromone.stamps.begin(), _pheromone.stamps.end(), epoch);
+    fill(_transitions.dirty.begin(), _transitions.dirty.end(), 1);
+    fill(_transitions.rescan.begin(), _transitions.rescan.end(), 1);
+    _global_best.clear();
+    _restarts++;
+}
+
+int ACOSolver::findArc(int u, int v)
+{
+    network_index &index = _network->getIndex();
+    return _option.residual_graph ? index.findStep(u, v) : index.findOutEdge(u, v);
+}
+
+void ACOSolver::markDirty(const int *path, int size)
+{
+    for (int i = 0; i < size - 1; i++)
+        _transitions.dirty[GET_NODE_NORMAL_ID(path[i])] = 1;
+}
+
+void ACOSolver::updateDistances()
+{
+    network_index &index = _network->getIndex();
+    const vector<int> &changed = _distances.update(_changed_edges.data(), _changed_edges.size());
+    _changed_edges.clear();
+
+    //le tabelle che dipendono da un'etichetta cambiata sono quelle del nodo e dei suoi vicini, e
+    //le loro liste di candidati vanno rifatte perche' cambia l'ordine degli archi
+    for (auto &&v : changed)
+    {
+        _transitions.dirty[v] = _transitions.rescan[v] = 1;
+        for (int i = index.in_offsets[v]; i < index.in_offsets[v + 1]; i++)
+        {
+            int u = index.tails[index.in_edges[i]];
+            _transitions.dirty[u] = _transitions.rescan[u] = 1;
+        }
+        for (int i = index.out_offsets[v]; i < index.out_offsets[v + 1]; i++)
+        {
+            int w = index.heads[index.out_edges[i]];
+            _transitions.dirty[w] = _transitions.rescan[w] = 1;
+        }
+    }
+}
+
+double ACOSolver::augmentPath(const int *path, int size, int epoch)
+{
+    _path_edges.clear();
+    bool is_new = false;
+    for (int i = 0; i < size - 1; i++)
+    {
+        int e = findArc(GET_NODE_NORMAL_ID(path[i]), GET_NODE_NORMAL_ID(path[i + 1]));
+        if (e < 0)
+            return 0;
+        _path_edges.push_back(e);
+        is_new |= _augmented[e] != epoch;
+    }
+
+    //un cammino gia' coperto dagli aumenti precedenti sommerebbe solo un'altra frazione ni dello stesso residuo
+    double max_increment_flow = _network->getMinResidualCapacity(path, _path_edges.data(), size);
+    if (!is_new || !(max_increment_flow > 0) || isinf(max_increment_flow))
+        return 0;
+
+    //sui passi all'indietro updateFlow annulla il flusso dell'arco inverso
+    double increment_flow = max_increment_flow * _option.ni;
+    _network->updateFlow(path, _path_edges.data(), size, increment_flow);
+    for (auto &&e : _path_edges)
+        _augmented[e] = epoch;
+
+    //pushArcFlow puo' cambiare entrambi gli archi della coppia
+    if (_option.beta3 > 0 || _option.candidate_list > 0)
+    {
+        network_index &index = _network->getIndex();
+        for (auto &&arc : _path_edges)
+        {
+            int pair[2] = {arc, index.reverse[arc]};
+            for (auto &&e : pair)
             {
-                deletePath(l);
-                stat->invalid++;
+                if (e < 0)
+                    continue;
+                if (_option.beta3 > 0)
+                    _changed_edges.push_back(e);
+                if (_option.candidate_list > 0)
+                    _transitions.changed.push_back(e);
             }
         }
+    }
+    markDirty(path, size);
+    return increment_flow;
+}
+
+void ACOSolver::initialize(int threads)
+{
+    int colony_size = this->_option.colony_size;
+    //la navigazione e' limitata dalla lunghezza del cammino e dalle rimozioni, non dal numero di archi
+    _run.max_size_path = this->_network->getIndex().count_nodes;
+    _run.max_erased_nodes = this->_network->getIndex().count_nodes;
+    _run.flow_upperbound = this->_network->getFlowUpperbound();
+
+    if (_option.seed >= 0)
+        _random->seed(_option.seed);
+
+    _run.pool = new ThreadPool(threads);
+    _run.workers.assign(_run.pool->size(), aco_worker());
+    for (auto &&worker : _run.workers)
+        worker.solver = this;
+    _run.seeds.resize(colony_size);
+    _run.paths.resize(colony_size);
+    _run.owners.resize(colony_size);
+    _run.candidates.clear();
+    _run.candidates.reserve(colony_size);
+
+    _network->reset(false, false, true, true, true, _option.pheromone / 2.0);
+    buildTransitions();
+
+    network_index &index = _network->getIndex();
+    int count_edges = index.count_edges;
+    for (auto &&worker : _run.workers)
+        worker.tabu.resize(index.count_nodes);
+    _pheromone.tau.resize(count_edges);
+    _pheromone.tau_min = 0;
+    _pheromone.tau_max = INFINITY;
+    //in MMAS si parte da una stima per eccesso di tau_max, i limiti veri arrivano con il primo cammino
+    fillArray(_pheromone.tau.data(), count_edges, _option.mmas ? _option.pheromone / _option.rho : _option.pheromone / 2.0);
+    _pheromone.stamps.assign(count_edges, 0);
+    _pheromone.counters.assign(count_edges, 1);
+    _pheromone.visited.assign(count_edges, 0);
+    _augmented.assign(count_edges, 0);
+    _changed_edges.clear();
+    if (_option.beta3 > 0)
+        _distances.build(index, _option.residual_graph);
+    _history.reset(count_edges, _option.snapshot_period);
+    _pheromone.touched.clear();
+    _pheromone.decay.resize(_option.max_interations + 1);
+    for (int k = 0; k <= _option.max_interations; k++)
+        _pheromone.decay[k] = pow(1 - _option.rho, k);
+}
+
+bool ACOSolver::isRunning()
+{
+    //con le distanze si sa quando nessun cammino incrementale e' piu' disponibile
+    if (_option.beta3 > 0 && !_distances.isReachable(GET_NODE_NORMAL_ID(ID_NODE_SOURCE)))
+        return false;
+    return this->_current_interation < this->_option.max_interations &&
+           (this->_best_result == nullptr || this->_best_result->fitness < _run.flow_upperbound);
+}
+
+void ACOSolver::step()
+{
+    network_index &index = _network->getIndex();
+    int count_edges = index.count_edges;
+    int colony_size = this->_option.colony_size;
+    vector<aco_worker> &workers = _run.workers;
+    vector<unsigned int> &seeds = _run.seeds;
+    vector<path_span> &paths = _run.paths;
+    vector<int> &owners = _run.owners;
+    vector<int> &candidates = _run.candidates;
+
+    statistic *stat = new statistic();
+    this->_statistics.push_back(stat);
 
-        //aggiorno il ferormone
-        int edges_traversed = 0, edges_not_traversed = 0;
-        for (auto &&edge : _network->getTopology())
+    stat->start_timestamp = GET_CURRENT_TIMESTAMP;
+
+    //i semi sono estratti in ordine, cosi' il risultato non dipende dal numero di thread
+    for (int k = 0; k < colony_size; k++)
+        seeds[k] = _random->generator()();
+
+    //tau, flusso e contatori cambiano solo tra un'iterazione e l'altra. In MMAS i limiti rompono
+    //la scala uniforme dell'evaporazione, quindi le tabelle vanno ricostruite tutte
+    if (_option.mmas)
+        fill(_transitions.dirty.begin(), _transitions.dirty.end(), 1);
+    updateTransitions(this->_current_interation);
+
+    //le formiche navigano in parallelo sulla rete in sola lettura
+    _run.pool->run(colony_size, [&](int k, int index)
+                   {
+                       aco_worker &worker = workers[index];
+                       worker.random.seed(seeds[k]);
+
+                       aco_selector select = {this->_network, &worker};
+                       paths[k] = this->_network->navigate(select, worker.arena, worker.tabu, _run.max_size_path, _run.max_erased_nodes, false);
+                       owners[k] = index;
+                   });
+
+    int epoch = this->_current_interation + 1;
+    int edges_traversed = 0;
+    for (auto &&worker : workers)
+    {
+        for (auto &&e : worker.hops)
         {
-            double delta_tau = 0;
-            if (CONTAINS_SET(visited_edges, edge.first))
+            _pheromone.counters[e]++;
+            if (_pheromone.visited[e] != epoch)
             {
-                delta_tau = (double)colony_size * _option.pheromone / (double)edge.second.counter;
+                _pheromone.visited[e] = epoch;
+                _pheromone.touched.push_back(e);
+                _transitions.dirty[index.tails[e]] = 1;
+                if (_option.residual_graph)
+                    _transitions.dirty[index.heads[e]] = 1;
+                if (_option.candidate_list > 0)
+                    _transitions.changed.push_back(e);
                 edges_traversed++;
             }
-            else
-            {
-                edges_not_traversed++;
-            }
+        }
+        worker.hops.clear();
+    }
 
-            edge.second.tau = ((1 - _option.rho) * edge.second.tau) + delta_tau;
+    //cammini validi dal piu' corto, a parita' di lunghezza vince la prima formica
+    candidates.clear();
+    for (int k = 0; k < colony_size; k++)
+    {
+        if (workers[owners[k]].arena.isValid(paths[k]))
+            candidates.push_back(k);
+        else
+            stat->invalid++;
+    }
+    stable_sort(candidates.begin(), candidates.end(), [&](int a, int b)
+                { return paths[a].size < paths[b].size; });
+
+    int *min_path = nullptr;
+    int min_size = 0;
+    if (!candidates.empty())
+    {
+        min_path = workers[owners[candidates[0]]].arena.data(paths[candidates[0]]);
+        min_size = paths[candidates[0]].size;
+    }
+
+    //aggiorno il ferormone
+    int edges_not_traversed = count_edges - edges_traversed;
+    if (_option.mmas)
+    {
+        //il migliore globale saturato non e' piu' un cammino incrementale
+        if (!_global_best.empty() && this->_network->getMinResidualCapacity(_global_best.data(), _global_best.size()) <= 0)
+            _global_best.clear();
+        if (min_path != nullptr && (_global_best.empty() || min_size < (int)_global_best.size()))
+            _global_best.assign(min_path, min_path + min_size);
+
+        //alterna il migliore dell'iterazione e il migliore globale
+        const int *best_path = min_path;
+        int best_size = min_size;
+        if (!_global_best.empty() && (best_path == nullptr || (_option.mmas_global_period > 0 && epoch % _option.mmas_global_period == 0)))
+        {
+            best_path = _global_best.data();
+            best_size = _global_best.size();
         }
 
-        //calcolo il cammino incrementale
-        network_path augmenting_path = this->_network->normalizePath(min_path);
-        double increment_flow = 0;
-        if (augmenting_path != emptyPath)
+        if (best_path != nullptr)
         {
-            //aggiorno il flusso lungo il cammino incrementale
-            double max_increment_flow = this->_network->getMinResidualCapacity(augmenting_path);
-            if (max_increment_flow > 0)
-            {
-                increment_flow = max_increment_flow * _option.ni;
-                this->_network->updateFlow(augmenting_path, increment_flow);
-                stat->alfa += increment_flow;
-            }
+            updateBounds(_global_best.empty() ? best_size : _global_best.size());
+            updatePheromoneMMAS(epoch, best_path, best_size);
         }
         else
         {
-            stat->beta = 1;
+            _pheromone.touched.clear();
         }
+    }
+    else
+    {
+        updatePheromone(epoch);
+    }
 
-        stat->end_timestamp = GET_CURRENT_TIMESTAMP;
+    //il fattore di ramificazione misura la convergenza in entrambe le modalita'
+    bool restart = false;
+    if (epoch % ACO_BRANCHING_PERIOD == 0)
+    {
+        _branching = computeBranching(epoch);
+        if (_option.mmas && _branching < _option.mmas_branching)
+        {
+            restartPheromone(epoch);
+            restart = true;
+        }
+    }
+    stat->branching = _branching;
+    stat->restarts = _restarts;
 
-        //ottengo il flusso
-        double current_flow = this->_network->getFlow();
+    //i cammini sono gia' senza cicli: si aumentano in ordine di lunghezza finche' restano
+    //compatibili con il residuo lasciato dai precedenti. Con un solo cammino si prova soltanto
+    //il piu' corto, anche se e' gia' saturo
+    int *augmenting_path = nullptr;
+    int augmenting_size = 0;
+    int augmenting_count = 0;
+    int attempts = 0;
+    double increment_flow = 0;
+    for (auto &&k : candidates)
+    {
+        if (_option.max_augmenting_paths > 0 && augmenting_count >= _option.max_augmenting_paths)
+            break;
+        if (_option.max_augmenting_paths == 1 && attempts++ > 0)
+            break;
 
+        int *path = workers[owners[k]].arena.data(paths[k]);
+        double increment = augmentPath(path, paths[k].size, epoch);
+        if (increment > 0)
+        {
+            if (augmenting_path == nullptr)
+            {
+                augmenting_path = path;
+                augmenting_size = paths[k].size;
+            }
+            augmenting_count++;
+            increment_flow += increment;
+        }
+    }
+    stat->alfa += increment_flow;
+    if (_option.beta3 > 0)
+        updateDistances();
+    if (min_path == nullptr)
+        stat->beta = 1;
+
+    stat->end_timestamp = GET_CURRENT_TIMESTAMP;
+
+    //ottengo il flusso
+    double current_flow = this->_network->getFlow();
+
+    if (!_quiet)
         EXECUTIVE_LOGGER_CONSOLE(endl
                                  << "Iteration: " << _current_interation << endl
-                                 << "Best Path: " << graph::to_string(min_path) << endl
+                                 << "Best Path: " << restorePath(min_path, min_size) << endl
                                  << "Invalid Path: " << std::to_string(stat->invalid) << endl
-                                 << "Augmenting Path: " << graph::to_string(augmenting_path) << endl
+                                 << "Augmenting Path: " << restorePath(augmenting_path, augmenting_size) << endl
+                                 << "Augmenting Paths: " << std::to_string(augmenting_count) << endl
                                  << "Edges traversed: " << std::to_string(edges_traversed) << endl
                                  << "Edges not traversed: " << std::to_string(edges_not_traversed) << endl
                                  << "All edges: " << std::to_string(this->_network->countEdges()) << endl
                                  << "Increment flow: " << core::to_string(increment_flow, 5) << endl
-                                 << "Total flow: " << core::to_string(current_flow, 5) << endl);
+                                 << "Total flow: " << core::to_string(current_flow, 5) << endl
+                                 << "Branching factor: " << core::to_string(_branching, 5) << (restart ? " (restart)" : "") << endl);
 
-        deletePath(min_path);
-        deletePath(augmenting_path);
+    //i cammini dell'iterazione non servono piu'
+    for (auto &&worker : workers)
+        worker.arena.reset();
 
-        stat->fitness = current_flow;
-        stat->avg_fitness = current_flow / colony_size;
-        stat->interations = this->_current_interation;
-        /*{
-            int removed_edges = 0;
-            if (this->_option.remove_edge)
+    stat->fitness = current_flow;
+    stat->avg_fitness = current_flow / colony_size;
+    stat->interations = this->_current_interation;
+    /*{
+        int removed_edges = 0;
+        if (this->_option.remove_edge)
+        {
+            this->_network->enableAllEdges();
+            for (auto &&edge : visited_edges)
             {
-                this->_network->enableAllEdges();
-                for (auto &&edge : visited_edges)
+                if (this->_random->prob(_option.remove_edge_probs))
                 {
-                    if (this->_random->prob(_option.remove_edge_probs))
+                    if (this->_network->disableEdge(edge))
                     {
-                        if (this->_network->disableEdge(edge))
-                        {
-                            removed_edges++;
-                        }
+                        removed_edges++;
                     }
                 }
             }
+        }
 
-            stat->count_edges = this->_network->countEdges() - removed_edges;
-            stat->count_nodes = this->_network->countNodes();
-        }*/
-        stat->count_edges = this->_network->countEdges();
+        stat->count_edges = this->_network->countEdges() - removed_edges;
         stat->count_nodes = this->_network->countNodes();
+    }*/
+    stat->count_edges = this->_network->countEdges();
+    stat->count_nodes = this->_network->countNodes();
 
-        AcoSolution *solution = new AcoSolution();
-        solution->extract(this->_network);
-        stat->output = solution;
+    //i flussi sono registrati come differenze, con una copia completa per i nuovi migliori
+    bool is_best = this->_best_result == nullptr || stat->fitness > this->_best_result->fitness;
+    stat->output = new AcoSolution(&_history, _history.record(this->_network, is_best), current_flow);
 
-        this->_current_interation++;
-        if (this->_best_result == nullptr || stat->fitness > this->_best_result->fitness)
+    this->_current_interation++;
+    if (this->_best_result == nullptr || stat->fitness > this->_best_result->fitness)
+    {
+        this->_best_result = stat;
+    }
+    stat->iterations_to_best = this->_best_result->interations;
+
+    EXECUTIVE_LOGGER(endl << "Statistiche" << endl
+                          << to_string(stat),
+                     false);
+}
+
+void ACOSolver::finalize()
+{
+    network_index &index = _network->getIndex();
+
+    //in modalita' isole la rete prende i flussi dell'isola migliore
+    int best = 0;
+    for (int i = 1; i <= (int)_islands.size(); i++)
+    {
+        if (getIsland(i)->_network->getFlow() > getIsland(best)->_network->getFlow())
+            best = i;
+    }
+    if (best != 0)
+        copyFlows(best);
+
+    //riporta il ferormone sulla rete
+    for (int i = 0; i < index.count_edges; i++)
+    {
+        index.edges[i]->tau = getTau(i, this->_current_interation);
+        index.edges[i]->counter = _pheromone.counters[i];
+    }
+
+    for (auto &&island : _islands)
+    {
+        island->releaseRun();
+        island->dispose();
+        delete island->_random;
+        delete island;
+    }
+    _islands.clear();
+    _island_edges.clear();
+    releaseRun();
+}
+
+void ACOSolver::releaseRun()
+{
+    delete _run.pool;
+    _run.pool = nullptr;
+    _run.workers.clear();
+}
+
+void ACOSolver::createIslands()
+{
+    network_index &index = _network->getIndex();
+    int count_islands = _option.islands;
+
+    //l'isola 0 e' il solver stesso, ogni isola ha la sua rete, il suo ferormone e nessun thread interno
+    _islands.clear();
+    _island_edges.assign(count_islands, vector<int>(index.count_edges));
+    for (int e = 0; e < index.count_edges; e++)
+        _island_edges[0][e] = e;
+    for (int i = 1; i < count_islands; i++)
+    {
+        ACOSolver *island = new ACOSolver();
+        island->_option = _option;
+        island->_option.islands = 1;
+        island->_option.threads = 1;
+        //i semi delle isole sono estratti in ordine dal generatore del solver
+        island->_option.seed = _option.seed >= 0 ? _option.seed + i : (long)(_random->generator()() >> 1);
+        island->_quiet = true;
+        island->_state = SOLVER_READY;
+        buildNetwork(island->_network, _network->getTopology());
+
+        //gli indici degli archi della copia seguono l'ordine della mappa, non quello della rete
+        network_index &island_index = island->_network->getIndex();
+        for (int e = 0; e < index.count_edges; e++)
+            _island_edges[i][e] = island_index.findOutEdge(index.tails[e], index.heads[e]);
+
+        island->_start_timestamp = GET_CURRENT_TIMESTAMP;
+        island->_state = SOLVER_COMPUTING;
+        island->initialize(1);
+        _islands.push_back(island);
+    }
+}
+
+void ACOSolver::copyFlows(int island)
+{
+    network_index &index = _network->getIndex();
+    network_index &source_index = getIsland(island)->_network->getIndex();
+    const vector<int> &edges = _island_edges[island];
+    for (int e = 0; e < index.count_edges; e++)
+        index.edges[e]->flow = source_index.edges[edges[e]]->flow;
+}
+
+void ACOSolver::migrate()
+{
+    int count_islands = _option.islands;
+    int count_edges = _network->getIndex().count_edges;
+
+    //le isole sono ferme: si fotografano tutte prima di scrivere, cosi' l'anello non si propaga
+    vector<vector<double>> snapshot(count_islands, vector<double>(count_edges));
+    vector<double> flows(count_islands);
+    vector<vector<int>> best_paths(count_islands);
+    for (int i = 0; i < count_islands; i++)
+    {
+        ACOSolver *island = getIsland(i);
+        network_index &island_index = island->_network->getIndex();
+        const vector<int> &edges = _island_edges[i];
+        int now = island->_current_interation;
+        for (int e = 0; e < count_edges; e++)
         {
-            this->_best_result = stat;
+            if (_option.migration == MIGRATION_BEST)
+                snapshot[i][e] = island_index.edges[edges[e]]->flow;
+            else
+                snapshot[i][e] = island->getTau(edges[e], now);
+        }
+        flows[i] = island->_network->getFlow();
+        best_paths[i] = island->_global_best;
+    }
+
+    //ogni isola riceve dalla precedente nell'anello
+    for (int i = 0; i < count_islands; i++)
+    {
+        int from = (i + count_islands - 1) % count_islands;
+        ACOSolver *island = getIsland(i);
+        network_index &island_index = island->_network->getIndex();
+        const vector<int> &edges = _island_edges[i];
+        int now = island->_current_interation;
+
+        if (_option.migration == MIGRATION_BEST)
+        {
+            if (flows[from] <= flows[i])
+                continue;
+            for (int e = 0; e < count_edges; e++)
+                island_index.edges[edges[e]]->flow = snapshot[from][e];
+            island->_global_best = best_paths[from];
+            if (_option.beta3 > 0)
+                island->_distances.build(island_index, _option.residual_graph);
+        }
+        else
+        {
+            double w = _option.island_blend;
+            for (int e = 0; e < count_edges; e++)
+            {
+                int k = edges[e];
+                island->_pheromone.tau[k] = (1 - w) * snapshot[i][e] + w * snapshot[from][e];
+                island->_pheromone.stamps[k] = now;
+            }
+        }
+        fill(island->_transitions.dirty.begin(), island->_transitions.dirty.end(), 1);
+        fill(island->_transitions.rescan.begin(), island->_transitions.rescan.end(), 1);
+    }
+}
+
+void ACOSolver::mergeStatistics(int first)
+{
+    //ogni riga dell'isola 0 prende i valori dell'isola con il flusso piu' alto alla stessa iterazione.
+    //L'isola 0 ha gia' aggiornato la migliore con le sue righe, quindi si riparte dall'inizio
+    int count_rows = this->_statistics.size();
+    this->_best_result = nullptr;
+    for (int r = 0; r < count_rows; r++)
+    {
+        statistic *stat = this->_statistics[r];
+        for (auto &&island : _islands)
+        {
+            if (r < first || r >= (int)island->_statistics.size())
+                continue;
+            statistic *other = island->_statistics[r];
+            if (other->fitness <= stat->fitness)
+                continue;
+
+            stat->fitness = other->fitness;
+            stat->avg_fitness = other->avg_fitness;
+            stat->invalid = other->invalid;
+            stat->alfa = other->alfa;
+            stat->beta = other->beta;
+            stat->gamma = other->gamma;
+            stat->branching = other->branching;
+            stat->restarts = other->restarts;
+            delete stat->output;
+            stat->output = new AcoSolution(*(AcoSolution *)other->output);
         }
 
-        visited_edges.clear();
+        if (this->_best_result == nullptr || stat->fitness > this->_best_result->fitness)
+            this->_best_result = stat;
+        stat->iterations_to_best = this->_best_result->interations;
+    }
+}
+
+void ACOSolver::runIslands()
+{
+    createIslands();
 
-        EXECUTIVE_LOGGER(endl << "Statistiche" << endl
-                              << to_string(stat),
-                         false);
+    //ogni isola gira su un thread per island_period iterazioni senza condividere nulla: il ritorno di
+    //run() e' la barriera, poi lo scambio avviene su un solo thread con le isole ferme
+    ThreadPool pool(_option.threads);
+    int count_islands = _option.islands;
+    int period = MAX(1, _option.island_period);
+
+    while (isRunning())
+    {
+        int first = this->_statistics.size();
+        pool.run(count_islands, [&](int i, int)
+                 {
+                     ACOSolver *island = getIsland(i);
+                     for (int k = 0; k < period && island->isRunning(); k++)
+                         island->step();
+                 });
+
+        mergeStatistics(first);
+        if (!isRunning())
+            break;
+
+        migrate();
+        EXECUTIVE_LOGGER_CONSOLE("Migration at iteration " << _current_interation << " (" << (_option.migration == MIGRATION_BEST ? "best" : "blend") << ")" << endl);
     }
+}
+
+void ACOSolver::solver()
+{
+
+    if (this->_state != SOLVER_READY)
+        throw "state is not valid";
+
+    this->_start_timestamp = GET_CURRENT_TIMESTAMP;
+    this->_state = SOLVER_COMPUTING;
+
+    //con le isole i thread vanno alle colonie e le formiche di ogni colonia girano in serie
+    if (_option.islands > 1)
+    {
+        initialize(1);
+        runIslands();
+    }
+    else
+    {
+        initialize(_option.threads);
+        while (isRunning())
+            step();
+    }
+    finalize();
 
     this->_end_timestamp = GET_CURRENT_TIMESTAMP;
     this->_state = SOLVER_COMPUTED;
@@ -294,11 +1166,29 @@ void ACOSolver::printInput(ostream &stream)
            << "Alfa: " << _option.alfa << endl
            << "Beta1: " << _option.beta1 << endl
            << "Beta2: " << _option.beta2 << endl
+           << "Beta3: " << _option.beta3 << endl
            << "Rho: " << _option.rho << endl
            << "Ni: " << _option.ni << endl
            << "Enable Remove Edges: " << _option.remove_edge << endl
            << "Remove Edges Probability: " << _option.remove_edge_probs << endl
-           << "MaxInterations: " << _option.max_interations << endl;
+           << "MaxInterations: " << _option.max_interations << endl
+           << "Threads: " << _option.threads << endl
+           << "Seed: " << _option.seed << endl
+           << "Eager Evaporation: " << _option.eager_evaporation << " (" << simdLevelName(getSimdLevel()) << ")" << endl
+           << "Max Augmenting Paths: " << _option.max_augmenting_paths << endl
+           << "Residual Graph: " << _option.residual_graph << endl
+           << "Snapshot Period: " << _option.snapshot_period << endl
+           << "Candidate List: " << _option.candidate_list << endl
+           << "Islands: " << _option.islands << endl
+           << "Island Period: " << _option.island_period << endl
+           << "Island Policy: " << (_option.migration == MIGRATION_BEST ? "best" : "blend") << endl
+           << "Island Blend: " << _option.island_blend << endl
+           << "MMAS: " << _option.mmas << endl
+           << "MMAS Global Period: " << _option.mmas_global_period << endl
+           << "MMAS PBest: " << _option.mmas_pbest << endl
+           << "MMAS Lambda: " << _option.mmas_lambda << endl
+           << "MMAS Branching: " << _option.mmas_branching << endl;
+    printReductionOption(stream);
 
     stream << "TOPOLOGY" << endl
            << _network->generateMATLABScript(false, false, false) << endl;
@@ -309,6 +1199,9 @@ void ACOSolver::printOutput(ostream &stream)
     stream << "Interation: " << this->_current_interation << endl
            << "BEST OUTPUT: " << endl
            << to_string(this->_best_result) << endl;
+    if (_option.mmas)
+        stream << "Restarts: " << _restarts << endl;
+    stream << "Snapshot memory: " << _history.memory() << " bytes" << endl;
 }
 
 void ACOSolver::setArguments(map<string, string> &optset)
@@ -324,6 +1217,9 @@ void ACOSolver::setArguments(map<string, string> &optset)
         string opt = pair.first;
         string &optarg = pair.second;
 
+        if (parseReductionOption(opt))
+            continue;
+
         if (opt == "pheromone")
         {
             _option.pheromone = stof(optarg);
@@ -348,6 +1244,10 @@ void ACOSolver::setArguments(map<string, string> &optset)
         {
             _option.beta2 = stof(optarg);
         }
+        else if (opt == "beta3")
+        {
+            _option.beta3 = stof(optarg);
+        }
         else if (opt == "ni")
         {
             _option.ni = stof(optarg);
@@ -364,6 +1264,75 @@ void ACOSolver::setArguments(map<string, string> &optset)
         {
             _option.remove_edge_probs = stof(optarg);
         }
+        else if (opt == "threads")
+        {
+            _option.threads = stoi(optarg);
+        }
+        else if (opt == "seed")
+        {
+            _option.seed = stol(optarg);
+        }
+        else if (opt == "eager_evaporation")
+        {
+            _option.eager_evaporation = true;
+        }
+        else if (opt == "max_augmenting_paths")
+        {
+            _option.max_augmenting_paths = stoi(optarg);
+        }
+        else if (opt == "residual_graph")
+        {
+            _option.residual_graph = true;
+        }
+        else if (opt == "snapshot_period")
+        {
+            _option.snapshot_period = stoi(optarg);
+        }
+        else if (opt == "candidate_list")
+        {
+            _option.candidate_list = stoi(optarg);
+        }
+        else if (opt == "islands")
+        {
+            _option.islands = stoi(optarg);
+        }
+        else if (opt == "island_period")
+        {
+            _option.island_period = stoi(optarg);
+        }
+        else if (opt == "island_policy")
+        {
+            if (optarg == "best")
+                _option.migration = MIGRATION_BEST;
+            else if (optarg == "blend")
+                _option.migration = MIGRATION_BLEND;
+            else
+                throw "migration policy is not valid";
+        }
+        else if (opt == "island_blend")
+        {
+            _option.island_blend = stof(optarg);
+        }
+        else if (opt == "mmas")
+        {
+            _option.mmas = true;
+        }
+        else if (opt == "mmas_global_period")
+        {
+            _option.mmas_global_period = stoi(optarg);
+        }
+        else if (opt == "mmas_pbest")
+        {
+            _option.mmas_pbest = stof(optarg);
+        }
+        else if (opt == "mmas_lambda")
+        {
+            _option.mmas_lambda = stof(optarg);
+        }
+        else if (opt == "mmas_branching")
+        {
+            _option.mmas_branching = stof(optarg);
+        }
         else if (opt == "enable_log")
         {
             this->_enable_log = true;
@@ -6,6 +6,17 @@
 
 namespace flowsolver
 {
+//estrazioni ripetute quando la formica sceglie un nodo gia' nel suo cammino
+#define ACO_TABU_RETRIES 3
+//ogni quante iterazioni si misura il fattore di ramificazione del ferormone
+#define ACO_BRANCHING_PERIOD 10
+
+    enum aco_migration
+    {
+        MIGRATION_BEST = 0, //l'isola riceve flusso e migliore globale della precedente se ha un flusso piu' alto
+        MIGRATION_BLEND = 1 //tau = (1 - island_blend) * tau + island_blend * tau della precedente
+    };
+
     typedef struct s_aco_option
     {
         double pheromone = 5;
@@ -14,33 +25,99 @@ namespace flowsolver
         double alfa = 3.0;
         double beta1 = 5.0;
         double beta2 = 5.0;
+        double beta3 = 0;   //peso della guida verso il target sulle distanze residue, 0 la disattiva
         double rho = 0.5;
         double ni = 1;
         bool remove_edge = false;
         double remove_edge_probs = 0.2;
         bool advanced_log = false;
+        int threads = 0;
+        long seed = -1;
+        bool eager_evaporation = false;
+        bool mmas = false;
+        int mmas_global_period = 5; //ogni quante iterazioni deposita il migliore globale, 0 mai
+        double mmas_pbest = 0.05;   //probabilita' di ricostruire il migliore a convergenza, fissa tau_min
+        double mmas_lambda = 0.05;
+        double mmas_branching = 1.2; //sotto questo fattore di ramificazione il ferormone viene reinizializzato
+        int max_augmenting_paths = 1; //cammini aumentati per iterazione, 0 tutti quelli compatibili
+        bool residual_graph = false;  //le formiche percorrono anche gli archi inversi con flusso
+        int islands = 1;              //colonie indipendenti, ognuna con rete e ferormone propri
+        int island_period = 10;       //iterazioni tra due migrazioni ad anello
+        aco_migration migration = MIGRATION_BEST;
+        double island_blend = 0.3;
+        int snapshot_period = 50;     //iterazioni tra due copie complete dei flussi
+        int candidate_list = 0;       //archi candidati per nodo tra cui sceglie la formica, 0 tutti
 
     } AcoOption;
 
+    //flussi degli archi per iterazione. Ogni registrazione salva solo gli archi cambiati rispetto
+    //alla precedente, con una copia completa ogni period registrazioni e per l'ultimo migliore:
+    //una registrazione si ricostruisce partendo dalla copia completa piu' vicina all'indietro
+    class AcoHistory
+    {
+    private:
+        typedef struct s_aco_record
+        {
+            vector<double> flows; //copia completa, vuota per le differenze
+            vector<int> edges;    //archi cambiati rispetto alla registrazione precedente
+            vector<double> values;
+            bool checkpoint;
+        } aco_record;
+
+        vector<aco_record> _records;
+        vector<double> _last; //flussi dell'ultima registrazione
+        int _period = 1;
+        int _last_checkpoint = 0;
+        int _best = -1; //copia completa fuori periodo dell'ultimo migliore
+
+    public:
+        void reset(int count_edges, int period);
+
+        //ritorna la versione della registrazione
+        int record(graph::network *network, bool best);
+
+        void reconstruct(int version, double *flows);
+
+        inline int countEdges() const
+        {
+            return _last.size();
+        }
+
+        //byte occupati dai flussi registrati
+        size_t memory() const;
+
+    private:
+        void demote(int version);
+    };
+
     class AcoSolution : public Solution
     {
     private:
         double *_flows = nullptr;
         int _count_edges = 0;
         double _max_flow = 0;
+        AcoHistory *_history = nullptr;
+        int _version = -1;
 
     public:
         inline AcoSolution() {}
 
+        //soluzione registrata nella storia del solver, i flussi vengono ricostruiti quando servono
+        inline AcoSolution(AcoHistory *history, int version, double max_flow)
+        {
+            this->_history = history;
+            this->_version = version;
+            this->_count_edges = history->countEdges();
+            this->_max_flow = max_flow;
+        }
+
+        //la copia ha sempre i flussi completi e non dipende dalla storia
         inline AcoSolution(const AcoSolution &s)
         {
             this->_count_edges = s._count_edges;
             this->_max_flow = s._max_flow;
             this->_flows = new double[s._count_edges];
-            for (int i = 0; i < s._count_edges; i++)
-            {
-                this->_flows[i] = s._flows[i];
-            }
+            s.getFlows(this->_flows);
         }
 
         inline ~AcoSolution()
@@ -58,13 +135,122 @@ namespace flowsolver
             return _max_flow;
         }
 
+        inline void getFlows(double *flows) const
+        {
+            if (_history != nullptr)
+                _history->reconstruct(_version, flows);
+            else
+                copy(_flows, _flows + _count_edges, flows);
+        }
+
         void extract(graph::network *network);
     };
 
+    class ACOSolver;
+
+    //buffer locali di un thread: le formiche non scrivono sulla rete, gli archi attraversati
+    //vengono uniti nei contatori prima dell'aggiornamento del ferormone
+    typedef struct s_aco_worker
+    {
+        ACOSolver *solver;
+        core::RandomNumberGenerator random;
+        vector<int> hops; //indici degli archi attraversati nell'iterazione, con ripetizioni
+        graph::path_arena arena;
+        graph::node_tabu tabu;
+    } aco_worker;
+
+    //stato del ferormone per indice di arco. visited[e] vale l'epoca dell'ultima iterazione in cui
+    //l'arco e' stato attraversato, cosi' non serve azzerarlo tra un'iterazione e l'altra.
+    //L'evaporazione e' pigra: tau[e] e' il valore alla fine dell'iterazione stamps[e] e viene
+    //scalato di decay[k] = (1 - rho)^k quando si legge, quindi ogni iterazione aggiorna solo gli
+    //archi attraversati (touched). Con eager_evaporation si aggiornano tutti gli archi ogni volta.
+    //In modalita' MMAS il valore letto e' limitato a [tau_min, tau_max]: l'evaporazione pigra con
+    //il limite inferiore applicato alla lettura coincide con quella limitata ad ogni iterazione.
+    typedef struct s_aco_pheromone
+    {
+        vector<double> tau;
+        vector<int> stamps;
+        vector<int> counters;
+        vector<int> visited;
+        vector<int> touched;
+        vector<double> decay;
+        double tau_min = 0;
+        double tau_max = INFINITY;
+    } aco_pheromone;
+
+    //probabilita' di transizione per nodo. Gli archi del nodo u sono in [offsets[u], offsets[u + 1]):
+    //prima gli archi uscenti dell'indice della rete, poi con residual_graph gli archi entranti percorsi
+    //all'indietro (heads[a] e' la coda dell'arco). Una tabella viene ricostruita solo se il nodo e'
+    //marcato sporco: con la sola evaporazione tutti i pesi del nodo scalano dello stesso fattore.
+    //La formica sceglie tra i posti del nodo in [slot_offsets[u], slot_offsets[u + 1]): senza
+    //candidate_list sono tutti gli archi, altrimenti i candidate_list archi migliori. Un arco fuori
+    //lista rientra quando cambia e supera il candidato piu' debole, e la lista si ricalcola su tutto
+    //il vicinato solo quando i candidati sono tutti saturi o disabilitati.
+    typedef struct s_aco_transitions
+    {
+        vector<int> offsets;
+        vector<int> edges;             //indice dell'arco della rete
+        vector<int> heads;             //id normale del nodo raggiunto
+        vector<double> attractiveness; //tau^alfa * residual^beta1 / counter^beta2, residual e' il flusso per gli archi inversi
+        vector<int> slot_offsets;
+        vector<int> slots;             //arco di ogni posto
+        vector<int> slot_of;           //posto di ogni arco, -1 se fuori lista
+        vector<double> weights;        //attrattivita' dei posti, contigua per la tabella alias
+        vector<int> forward_arcs;      //arco diretto di ogni arco della rete
+        vector<int> backward_arcs;     //arco inverso di ogni arco della rete, -1 se non c'e'
+        vector<int> changed;           //archi della rete con ferormone, contatore o residuo cambiati
+        vector<char> rescan;           //la lista del nodo va ricalcolata su tutti gli archi
+        vector<int> order;
+        vector<double> prob;
+        vector<int> alias;
+        vector<double> sums;       //somma dei pesi uscenti, 0 se il nodo non ha transizioni
+        vector<int> target_edges;  //arco verso il target o -1
+        vector<char> dirty;
+        vector<int> small;
+        vector<int> large;
+    } aco_transitions;
+
+    //buffer di un'esecuzione, creati da initialize() e rilasciati da finalize()
+    typedef struct s_aco_run
+    {
+        core::ThreadPool *pool = nullptr;
+        vector<aco_worker> workers;
+        vector<unsigned int> seeds;
+        vector<graph::path_span> paths;
+        vector<int> owners;
+        vector<int> candidates;
+        int max_size_path = 0;    //nodi di un cammino semplice, sorgente e target compresi
+        int max_erased_nodes = 0; //nodi che una formica puo' togliere rimuovendo i cicli
+        double flow_upperbound = 0;
+    } aco_run;
+
     class ACOSolver : public FlowSolver
     {
     private:
         AcoOption _option;
+        aco_transitions _transitions;
+        aco_pheromone _pheromone;
+
+        //MMAS: cammino piu' corto dall'ultima reinizializzazione, scartato quando si satura
+        vector<int> _global_best;
+        double _branching;
+        int _restarts;
+
+        //archi dei cammini aumentati, con l'epoca dell'ultima iterazione in cui sono stati usati
+        vector<int> _augmented;
+        vector<int> _path_edges;
+
+        //distanze esatte dal target nel grafo residuo, aggiornate con gli archi cambiati dagli aumenti
+        graph::residual_distance _distances;
+        vector<int> _changed_edges;
+
+        aco_run _run;
+        bool _quiet;
+        AcoHistory _history;
+
+        //isole oltre al solver stesso; _island_edges[i][e] e' l'arco dell'isola i per l'arco e del solver
+        vector<ACOSolver *> _islands;
+        vector<vector<int>> _island_edges;
 
     public:
         ACOSolver(/* args */);
@@ -74,6 +260,11 @@ namespace flowsolver
             return this->_option;
         }
 
+        inline aco_transitions &getTransitions()
+        {
+            return this->_transitions;
+        }
+
         void dispose();
 
         void reset();
@@ -86,10 +277,82 @@ namespace flowsolver
 
         void printOutput(ostream &stream);
 
+        inline bool hasEdgeFlows()
+        {
+            return true;
+        }
+
         inline void printStatistic(ostream &stream)
         {
-            printStatisticInternal(stream, true, false, true);
+            printStatisticInternal(stream, true, false, true, true);
+        }
+
+    private:
+        void initialize(int threads);
+
+        bool isRunning();
+
+        //una iterazione della colonia
+        void step();
+
+        void finalize();
+
+        void releaseRun();
+
+        inline ACOSolver *getIsland(int island)
+        {
+            return island == 0 ? this : _islands[island - 1];
+        }
+
+        void createIslands();
+
+        void runIslands();
+
+        void migrate();
+
+        void mergeStatistics(int first);
+
+        void copyFlows(int island);
+
+        void buildTransitions();
+
+        void updateTransitions(int now);
+
+        double getAttractiveness(int u, int arc, int now);
+
+        //ricalcola i candidati del nodo sugli archi piu' attrattivi di tutto il vicinato
+        void selectCandidates(int u, int now);
+
+        //l'arco entra nella lista del nodo se supera il candidato piu' debole
+        void offerCandidate(int u, int arc, int now);
+
+        void updatePheromone(int epoch);
+
+        void updatePheromoneMMAS(int epoch, const int *path, int size);
+
+        void updateBounds(int size);
+
+        //media sui nodi con ferormone differenziato degli archi sopra tau_min + lambda * (tau_max - tau_min)
+        double computeBranching(int now);
+
+        void restartPheromone(int epoch);
+
+        //arco del passo u -> v (id normali) su cui si deposita, diretto o inverso
+        int findArc(int u, int v);
+
+        inline double getTau(int edge, int now)
+        {
+            double tau = _pheromone.tau[edge] * _pheromone.decay[now - _pheromone.stamps[edge]];
+            return MIN(MAX(tau, _pheromone.tau_min), _pheromone.tau_max);
         }
+
+        void markDirty(const int *path, int size);
+
+        void updateDistances();
+
+        //aumenta il flusso lungo il cammino di ni volte la capacita' residua corrente. Ritorna 0 se
+        //il cammino e' saturo o se tutti i suoi archi sono gia' stati usati nell'iterazione
+        double augmentPath(const int *path, int size, int epoch);
     };
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,612 @@
+#include "electricalsolver.h"
+#include "ffsolver.h"
+
+using namespace flowsolver;
+using namespace core;
+using namespace graph;
+
+ElectricalSolver::ElectricalSolver()
+{
+    _exact_flow = NAN;
+    _exact_time = NAN;
+    _relative_error = NAN;
+}
+
+void ElectricalSolver::dispose()
+{
+    this->internalReset();
+    delete _network;
+}
+
+void ElectricalSolver::reset()
+{
+    this->internalReset();
+    _exact_flow = NAN;
+    _exact_time = NAN;
+    _relative_error = NAN;
+}
+
+void ElectricalSolver::buildCircuit()
+{
+    network_index &index = _network->getIndex();
+    int n = index.count_nodes;
+    int m = index.count_edges;
+
+    _wire_tails.clear();
+    _wire_heads.clear();
+    _wire_forward.clear();
+    _wire_backward.clear();
+
+    //gli archi antiparalleli diventano un unico filo, percorribile nei due versi secondo i residui
+    unordered_map<network_edgekey, int, network_edgekey_hasher> wires;
+    for (int i = 0; i < m; i++)
+    {
+        int a = index.tails[i];
+        int b = index.heads[i];
+        network_edge *edge = index.edges[i];
+        if (a == b || edge->capacity <= 0 || !edge->enable)
+            continue;
+
+        network_edgekey key(MIN(a, b), MAX(a, b));
+        int w;
+        auto it = wires.find(key);
+        if (it == wires.end())
+        {
+            w = _wire_tails.size();
+            wires.insert({key, w});
+            _wire_tails.push_back(a);
+            _wire_heads.push_back(b);
+            _wire_forward.push_back(-1);
+            _wire_backward.push_back(-1);
+        }
+        else
+        {
+            w = it->second;
+        }
+
+        if (_wire_tails[w] == a)
+            _wire_forward[w] = i;
+        else
+            _wire_backward[w] = i;
+    }
+
+    int count_wires = _wire_tails.size();
+    _wire_residuals.assign(2 * count_wires, 0.0);
+    _wire_blocked.assign(count_wires, 0);
+    _incident.assign(n, vector<int>());
+    vector<vector<int>> &incident = _incident;
+    for (int w = 0; w < count_wires; w++)
+    {
+        incident[_wire_tails[w]].push_back(w);
+        incident[_wire_heads[w]].push_back(w);
+    }
+
+    //solo la componente connessa del target porta corrente, il target e' a potenziale zero
+    int target = GET_NODE_NORMAL_ID(ID_NODE_TARGET);
+    vector<bool> reached(n, false);
+    queue<int> q;
+    q.push(target);
+    reached[target] = true;
+    while (!q.empty())
+    {
+        int u = q.front();
+        q.pop();
+        for (auto &&w : incident[u])
+        {
+            int v = _wire_tails[w] == u ? _wire_heads[w] : _wire_tails[w];
+            if (!reached[v])
+            {
+                reached[v] = true;
+                q.push(v);
+            }
+        }
+    }
+
+    int rows = 0;
+    _rows.assign(n, -1);
+    for (int u = 0; u < n; u++)
+    {
+        if (reached[u] && u != target)
+            _rows[u] = rows++;
+    }
+
+    _laplacian.rows = rows;
+    _laplacian.offsets.assign(rows + 1, 0);
+    _laplacian.columns.clear();
+    _diagonal_positions.assign(rows, -1);
+    _wire_positions.assign(2 * count_wires, -1);
+    for (int u = 0; u < n; u++)
+    {
+        int r = _rows[u];
+        if (r < 0)
+            continue;
+
+        _diagonal_positions[r] = _laplacian.columns.size();
+        _laplacian.columns.push_back(r);
+        for (auto &&w : incident[u])
+        {
+            bool is_tail = _wire_tails[w] == u;
+            int rv = _rows[is_tail ? _wire_heads[w] : _wire_tails[w]];
+            if (rv < 0)
+                continue;
+
+            _wire_positions[2 * w + (is_tail ? 0 : 1)] = _laplacian.columns.size();
+            _laplacian.columns.push_back(rv);
+        }
+        _laplacian.offsets[r + 1] = _laplacian.columns.size();
+    }
+    _laplacian.values.assign(_laplacian.columns.size(), 0.0);
+}
+
+void ElectricalSolver::updateResiduals()
+{
+    //nel verso tail->head si riempie l'arco diretto e si svuota quello inverso, e viceversa
+    int count_wires = _wire_tails.size();
+    for (int w = 0; w < count_wires; w++)
+    {
+        network_edge *forward = _wire_forward[w] >= 0 ? _network->getIndex().edges[_wire_forward[w]] : nullptr;
+        network_edge *backward = _wire_backward[w] >= 0 ? _network->getIndex().edges[_wire_backward[w]] : nullptr;
+        double up = 0, down = 0;
+        if (forward != nullptr)
+        {
+            up += forward->getResidualCapacity();
+            down += forward->flow;
+        }
+        if (backward != nullptr)
+        {
+            up += backward->flow;
+            down += backward->getResidualCapacity();
+        }
+        _wire_residuals[2 * w] = up > ELECTRICAL_RESIDUAL_EPSILON ? up : 0;
+        _wire_residuals[2 * w + 1] = down > ELECTRICAL_RESIDUAL_EPSILON ? down : 0;
+        _wire_blocked[w] = 0;
+    }
+}
+
+bool ElectricalSolver::hasResidualPath()
+{
+    int n = _incident.size();
+    int source = GET_NODE_NORMAL_ID(ID_NODE_SOURCE);
+    int target = GET_NODE_NORMAL_ID(ID_NODE_TARGET);
+    vector<bool> reached(n, false);
+    queue<int> q;
+    q.push(source);
+    reached[source] = true;
+    while (!q.empty())
+    {
+        int u = q.front();
+        q.pop();
+        if (u == target)
+            return true;
+        for (auto &&w : _incident[u])
+        {
+            bool is_tail = _wire_tails[w] == u;
+            int v = is_tail ? _wire_heads[w] : _wire_tails[w];
+            if (!reached[v] && _wire_residuals[2 * w + (is_tail ? 0 : 1)] > 0)
+            {
+                reached[v] = true;
+                q.push(v);
+            }
+        }
+    }
+    return false;
+}
+
+void ElectricalSolver::updateLaplacian(vector<double> &resistances)
+{
+    fill(_laplacian.values.begin(), _laplacian.values.end(), 0.0);
+
+    int count_wires = _wire_tails.size();
+    for (int w = 0; w < count_wires; w++)
+    {
+        double conductance = 1.0 / resistances[w];
+        int ra = _rows[_wire_tails[w]];
+        int rb = _rows[_wire_heads[w]];
+        if (ra >= 0)
+            _laplacian.values[_diagonal_positions[ra]] += conductance;
+        if (rb >= 0)
+            _laplacian.values[_diagonal_positions[rb]] += conductance;
+        if (_wire_positions[2 * w] >= 0)
+            _laplacian.values[_wire_positions[2 * w]] -= conductance;
+        if (_wire_positions[2 * w + 1] >= 0)
+            _laplacian.values[_wire_positions[2 * w + 1]] -= conductance;
+    }
+}
+
+void ElectricalSolver::pushWire(int w, double amount)
+{
+    //il flusso nel verso opposto si annulla prima di riempire l'arco nel verso richiesto
+    network_index &index = _network->getIndex();
+    int to = amount >= 0 ? _wire_forward[w] : _wire_backward[w];
+    int from = amount >= 0 ? _wire_backward[w] : _wire_forward[w];
+    amount = fabs(amount);
+    if (from >= 0)
+    {
+        network_edge *edge = index.edges[from];
+        double cancel = MIN(amount, edge->flow);
+        edge->flow -= cancel;
+        amount -= cancel;
+    }
+    if (to >= 0 && amount > 0)
+    {
+        network_edge *edge = index.edges[to];
+        edge->flow = MIN(edge->flow + amount, edge->capacity);
+    }
+}
+
+double ElectricalSolver::augment(vector<double> &currents, double scale)
+{
+    int n = _incident.size();
+    int count_wires = _wire_tails.size();
+    int source = GET_NODE_NORMAL_ID(ID_NODE_SOURCE);
+    int target = GET_NODE_NORMAL_ID(ID_NODE_TARGET);
+
+    //la corrente si tiene solo nei versi con residuo, ogni filo al piu' fino alla sua capacita'
+    vector<double> flows(count_wires), pushed(count_wires, 0.0);
+    for (int w = 0; w < count_wires; w++)
+    {
+        double f = currents[w] * scale;
+        double residual = getResidual(w, f);
+        flows[w] = _wire_blocked[w] || residual <= 0 ? 0 : (f >= 0 ? MIN(f, residual) : -MIN(-f, residual));
+    }
+
+    //scompone la corrente in cammini s-t: gli eccessi lasciati dal taglio restano nei rami morti,
+    //i cicli si annullano, quindi il flusso aumentato e' conservato in ogni nodo
+    vector<int> next(n, 0), path_nodes, path_wires;
+    vector<int> position(n, -1);
+    double value = 0;
+    int u = source;
+    path_nodes.push_back(source);
+    position[source] = 0;
+    while (true)
+    {
+        if (u == target)
+        {
+            double bottleneck = INFINITY;
+            for (auto &&w : path_wires)
+                bottleneck = MIN(bottleneck, fabs(flows[w]));
+            for (auto &&w : path_wires)
+            {
+                double step = flows[w] >= 0 ? bottleneck : -bottleneck;
+                flows[w] -= step;
+                pushed[w] += step;
+            }
+            value += bottleneck;
+
+            for (auto &&x : path_nodes)
+                position[x] = -1;
+            path_nodes.assign(1, source);
+            path_wires.clear();
+            position[source] = 0;
+            u = source;
+            continue;
+        }
+
+        int advance = -1, v = -1;
+        while (next[u] < (int)_incident[u].size())
+        {
+            int w = _incident[u][next[u]];
+            bool is_tail = _wire_tails[w] == u;
+            v = is_tail ? _wire_heads[w] : _wire_tails[w];
+            if (v != source && (is_tail ? flows[w] : -flows[w]) > ELECTRICAL_RESIDUAL_EPSILON)
+            {
+                advance = w;
+                break;
+            }
+            next[u]++;
+        }
+
+        if (advance >= 0 && position[v] >= 0)
+        {
+            //ciclo: si toglie il minimo lungo il ciclo e si riparte da v
+            int from = position[v];
+            double bottleneck = fabs(flows[advance]);
+            for (int i = from; i < (int)path_wires.size(); i++)
+                bottleneck = MIN(bottleneck, fabs(flows[path_wires[i]]));
+            flows[advance] -= flows[advance] >= 0 ? bottleneck : -bottleneck;
+            for (int i = from; i < (int)path_wires.size(); i++)
+                flows[path_wires[i]] -= flows[path_wires[i]] >= 0 ? bottleneck : -bottleneck;
+            for (int i = from + 1; i < (int)path_nodes.size(); i++)
+                position[path_nodes[i]] = -1;
+            path_nodes.resize(from + 1);
+            path_wires.resize(from);
+            u = v;
+        }
+        else if (advance >= 0)
+        {
+            position[v] = path_nodes.size();
+            path_nodes.push_back(v);
+            path_wires.push_back(advance);
+            u = v;
+        }
+        else if (u == source)
+        {
+            break;
+        }
+        else
+        {
+            //nodo senza uscite: la corrente che vi entra non arriva al target
+            int w = path_wires.back();
+            flows[w] = 0;
+            path_wires.pop_back();
+            position[u] = -1;
+            path_nodes.pop_back();
+            u = path_nodes.back();
+        }
+    }
+
+    for (int w = 0; w < count_wires; w++)
+    {
+        if (pushed[w] != 0)
+            pushWire(w, pushed[w]);
+    }
+    return value;
+}
+
+void ElectricalSolver::solver()
+{
+    if (this->_state != SOLVER_READY)
+        throw "state is not valid";
+
+    this->_start_timestamp = GET_CURRENT_TIMESTAMP;
+    this->_state = SOLVER_COMPUTING;
+
+    buildCircuit();
+    _network->reset(true, false, false, false, false);
+
+    int count_wires = _wire_tails.size();
+    int count_rows = _laplacian.rows;
+    int source_row = _rows[GET_NODE_NORMAL_ID(ID_NODE_SOURCE)];
+    double epsilon = _option.epsilon;
+
+    //si fa circolare un'unita' di corrente da s a t: il flusso stimato e' l'inverso della congestione
+    vector<double> weights(count_wires), resistances(count_wires), currents(count_wires), capacities(count_wires);
+    vector<double> average(count_wires), best_average(count_wires);
+    vector<double> potentials(count_rows, 0.0), b(count_rows, 0.0);
+    if (source_row >= 0)
+        b[source_row] = 1.0;
+
+    bool maximum = source_row < 0 || count_wires == 0;
+    while (!maximum && this->_current_interation < this->_option.max_phases)
+    {
+        updateResiduals();
+        if (!hasResidualPath())
+        {
+            maximum = true;
+            break;
+        }
+
+        statistic *stat = new statistic();
+        this->_statistics.push_back(stat);
+        stat->start_timestamp = GET_CURRENT_TIMESTAMP;
+
+        //la capacita' del filo parte dal verso piu' capiente e scende al residuo del verso percorso
+        for (int w = 0; w < count_wires; w++)
+            capacities[w] = MAX(_wire_residuals[2 * w], _wire_residuals[2 * w + 1]);
+        fill(weights.begin(), weights.end(), 1.0);
+        fill(average.begin(), average.end(), 0.0);
+        double estimate = 0, best_estimate = 0, width = 0, congestion = 0;
+        int cg_interations = 0, blocked = 0;
+        for (int k = 0; k < _option.max_interations; k++)
+        {
+            double total_weight = 0;
+            for (int w = 0; w < count_wires; w++)
+                total_weight += weights[w];
+
+            //i pesi sono normalizzati: le correnti non dipendono dalla scala delle resistenze
+            double smoothing = epsilon / (3.0 * count_wires);
+            for (int w = 0; w < count_wires; w++)
+                weights[w] /= total_weight;
+
+            bool violated = true;
+            while (violated)
+            {
+                for (int w = 0; w < count_wires; w++)
+                {
+                    double c = capacities[w];
+                    if (_wire_blocked[w])
+                        c = MAX(_wire_residuals[2 * w], _wire_residuals[2 * w + 1]);
+                    resistances[w] = (weights[w] + smoothing) / (c * c);
+                    if (_wire_blocked[w])
+                        resistances[w] *= ELECTRICAL_BLOCKED_RESISTANCE;
+                }
+
+                updateLaplacian(resistances);
+                cg_interations += _cg.solve(_laplacian, b.data(), potentials.data(), _option.cg_tolerance, _option.cg_max_interations);
+
+                //un filo percorso in un verso meno capiente si risolve con il residuo di quel verso,
+                //se il verso non ha residuo il filo e' bloccato. Le capacita' scendono soltanto,
+                //quindi le nuove soluzioni sono al piu' due per filo
+                violated = false;
+                for (int w = 0; w < count_wires; w++)
+                {
+                    int ra = _rows[_wire_tails[w]];
+                    int rb = _rows[_wire_heads[w]];
+                    double pa = ra >= 0 ? potentials[ra] : 0;
+                    double pb = rb >= 0 ? potentials[rb] : 0;
+                    currents[w] = (pa - pb) / resistances[w];
+                    double residual = getResidual(w, currents[w]);
+                    if (_wire_blocked[w] || currents[w] == 0 || residual >= capacities[w])
+                        continue;
+
+                    if (residual <= 0)
+                    {
+                        _wire_blocked[w] = 1;
+                        blocked++;
+                    }
+                    capacities[w] = residual;
+                    violated = true;
+                }
+            }
+
+            width = 0;
+            for (int w = 0; w < count_wires; w++)
+            {
+                if (!_wire_blocked[w])
+                    width = MAX(width, fabs(currents[w]) / getResidual(w, currents[w]));
+            }
+
+            congestion = 0;
+            for (int w = 0; w < count_wires; w++)
+            {
+                average[w] += (currents[w] - average[w]) / (double)(k + 1);
+                if (_wire_blocked[w])
+                    continue;
+                if (width > 0)
+                    weights[w] *= 1.0 + epsilon * (fabs(currents[w]) / getResidual(w, currents[w])) / width;
+                double residual = getResidual(w, average[w]);
+                if (residual > 0)
+                    congestion = MAX(congestion, fabs(average[w]) / residual);
+            }
+
+            estimate = congestion > 0 ? 1.0 / congestion : 0;
+            if (estimate > best_estimate)
+            {
+                best_estimate = estimate;
+                best_average = average;
+            }
+        }
+
+        double increment = best_estimate > 0 ? augment(best_average, best_estimate) : 0;
+        double flow = _network->getFlow();
+
+        stat->end_timestamp = GET_CURRENT_TIMESTAMP;
+        stat->interations = this->_current_interation;
+        stat->fitness = flow;
+        stat->avg_fitness = best_estimate;
+        stat->invalid = blocked;
+        stat->alfa = width;
+        stat->beta = cg_interations;
+        stat->gamma = increment;
+        stat->count_edges = this->_network->countEdges();
+        stat->count_nodes = this->_network->countNodes();
+        stat->output = new ElectricalSolution(flow, best_estimate > 0 ? 1.0 / best_estimate : 0);
+
+        if (this->_best_result == nullptr || stat->fitness >= this->_best_result->fitness)
+            this->_best_result = stat;
+
+        EXECUTIVE_LOGGER_CONSOLE(endl
+                                 << "Phase: " << _current_interation << endl
+                                 << "Width: " << core::to_string(width, 5) << endl
+                                 << "CG iterations: " << std::to_string(cg_interations) << endl
+                                 << "Blocked wires: " << std::to_string(blocked) << endl
+                                 << "Estimate: " << core::to_string(best_estimate, 5) << endl
+                                 << "Increment flow: " << core::to_string(increment, 5) << endl
+                                 << "Flow: " << core::to_string(flow, 5) << endl);
+
+        //gli incrementi delle fasi calano in fretta: sotto epsilon^2 del flusso il guadagno residuo e' trascurabile
+        this->_current_interation++;
+        if (increment <= ELECTRICAL_RESIDUAL_EPSILON || increment <= epsilon * epsilon * flow)
+            break;
+    }
+
+    //nessuna fase eseguita: la source non raggiunge il target
+    if (this->_best_result == nullptr)
+    {
+        statistic *stat = new statistic();
+        stat->start_timestamp = stat->end_timestamp = GET_CURRENT_TIMESTAMP;
+        stat->fitness = _network->getFlow();
+        stat->output = new ElectricalSolution(stat->fitness, 0);
+        this->_statistics.push_back(stat);
+        this->_best_result = stat;
+    }
+
+    this->_end_timestamp = GET_CURRENT_TIMESTAMP;
+    this->_state = SOLVER_COMPUTED;
+
+    double executive_time;
+    TIMESTAMP_ELAPSED_MS(this->_start_timestamp, this->_end_timestamp, executive_time);
+    EXECUTIVE_LOGGER("Total time: " << executive_time << "ms (" << spmvKernelName() << ")" << (maximum ? ", no residual path left" : ""), true);
+
+    if (_option.compare_exact)
+    {
+        vector<vector<double>> adjMatrix;
+        int source, sink;
+        _network->populateAdjMatrix(adjMatrix, &source, &sink);
+
+        TIMESTAMP start = GET_CURRENT_TIMESTAMP;
+        _exact_flow = FordFulkerson(adjMatrix, source, sink);
+        TIMESTAMP end = GET_CURRENT_TIMESTAMP;
+        TIMESTAMP_ELAPSED_MS(start, end, _exact_time);
+
+        double flow = this->_best_result->fitness;
+        _relative_error = _exact_flow != 0 ? (_exact_flow - flow) / _exact_flow : 0;
+        EXECUTIVE_LOGGER("Exact flow: " << _exact_flow << " (" << _exact_time << "ms)" << endl
+                                        << "Relative error: " << to_string_format(_relative_error),
+                         true);
+    }
+}
+
+void ElectricalSolver::setArguments(map<string, string> &optset)
+{
+    if (this->_state != SOLVER_INIT)
+        throw "state is not valid";
+
+    for (auto &&pair : optset)
+    {
+        string opt = pair.first;
+        string &optarg = pair.second;
+
+        if (parseReductionOption(opt))
+            continue;
+
+        if (opt == "max_interations")
+        {
+            _option.max_interations = stoi(optarg);
+        }
+        else if (opt == "max_phases")
+        {
+            _option.max_phases = stoi(optarg);
+        }
+        else if (opt == "epsilon")
+        {
+            _option.epsilon = stod(optarg);
+        }
+        else if (opt == "cg_tolerance")
+        {
+            _option.cg_tolerance = stod(optarg);
+        }
+        else if (opt == "cg_max_interations")
+        {
+            _option.cg_max_interations = stoi(optarg);
+        }
+        else if (opt == "compare_exact")
+        {
+            _option.compare_exact = true;
+        }
+        else if (opt == "enable_log")
+        {
+            this->_enable_log = true;
+            setLogFile(optarg);
+        }
+    }
+    this->_state = SOLVER_READY;
+}
+
+void ElectricalSolver::printInput(ostream &stream)
+{
+    stream << "PARAMETERS" << endl
+           << "MaxInterations: " << _option.max_interations << endl
+           << "MaxPhases: " << _option.max_phases << endl
+           << "Epsilon: " << _option.epsilon << endl
+           << "CG Tolerance: " << _option.cg_tolerance << endl
+           << "CG MaxInterations: " << _option.cg_max_interations << endl
+           << "Compare Exact: " << _option.compare_exact << endl;
+    printReductionOption(stream);
+
+    stream << "TOPOLOGY" << endl
+           << _network->generateMATLABScript(true, false, false) << endl;
+}
+
+void ElectricalSolver::printOutput(ostream &stream)
+{
+    stream << "Interation: " << this->_current_interation << endl
+           << "BEST OUTPUT: " << endl
+           << to_string(this->_best_result) << endl;
+    if (!isnan(_exact_flow))
+    {
+        stream << "Exact flow: " << _exact_flow << endl
+               << "Exact time: " << _exact_time << "ms" << endl
+               << "Relative error: " << _relative_error << endl;
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+#ifndef _H_ELS
+#define _H_ELS
+
+#include "flowsolverbase.h"
+
+namespace flowsolver
+{
+//residuo sotto il quale un verso del filo e' considerato saturo
+#define ELECTRICAL_RESIDUAL_EPSILON 1e-9
+//fattore sulla resistenza dei fili bloccati: restano nel circuito per non isolare i nodi
+#define ELECTRICAL_BLOCKED_RESISTANCE 1e6
+
+    typedef struct s_electrical_option
+    {
+        int max_interations = 50; //iterazioni multiplicative weights per fase
+        int max_phases = 20;
+        double epsilon = 0.1;
+        double cg_tolerance = 1e-8;
+        int cg_max_interations = 1000;
+        bool compare_exact = false;
+
+    } ElectricalOption;
+
+    class ElectricalSolution : public Solution
+    {
+    private:
+        double _flow = 0;
+        double _congestion = 0;
+
+    public:
+        inline ElectricalSolution() {}
+
+        inline ElectricalSolution(double flow, double congestion)
+        {
+            _flow = flow;
+            _congestion = congestion;
+        }
+
+        inline string toString(bool compact)
+        {
+            stringstream ss;
+            if (compact)
+                ss << core::to_string_format(_flow);
+            else
+                ss << "Max Flow " << _flow << endl
+                   << "\t"
+                   << "Congestion: " << _congestion << endl;
+            return ss.str();
+        }
+        inline bool isBest(Solution *solution)
+        {
+            return this->_flow > ((ElectricalSolution *)solution)->_flow;
+        }
+        inline double getFitness()
+        {
+            return _flow;
+        }
+    };
+
+    //flusso massimo approssimato con flussi elettrici e multiplicative weights (Christiano et al.).
+    //Ogni fase instrada un flusso elettrico sul grafo residuo: il filo di una coppia di archi
+    //antiparalleli ha una capacita' residua per verso e la corrente che scorre in un verso senza
+    //residuo blocca il filo per il resto della fase. La corrente media viene ridotta arco per arco
+    //alla capacita' residua, scomposta in cammini s-t (gli eccessi e i cicli si scartano) e
+    //aumentata sulla rete, quindi il flusso scritto e' sempre ammissibile e conservato. Le fasi
+    //finiscono quando il target non e' piu' raggiungibile nel grafo residuo, cioe' al flusso massimo,
+    //o quando una fase non aumenta il flusso.
+    class ElectricalSolver : public FlowSolver
+    {
+    private:
+        ElectricalOption _option;
+        core::csr_matrix _laplacian;
+        core::ConjugateGradient _cg;
+
+        //archi non orientati del circuito
+        vector<int> _wire_tails;
+        vector<int> _wire_heads;
+        vector<int> _wire_forward;            //arco tail->head della topologia o -1
+        vector<int> _wire_backward;           //arco head->tail della topologia o -1
+        vector<double> _wire_residuals;       //capacita' residue tail->head e head->tail, due per filo
+        vector<char> _wire_blocked;           //corrente contro un verso senza residuo nella fase
+        vector<int> _wire_positions;          //posizioni (tail, head) e (head, tail) nella laplaciana
+        vector<vector<int>> _incident;        //fili di ogni nodo, per id normalizzato
+        vector<int> _rows;                    //id normalizzato -> riga della laplaciana, -1 per il target
+        vector<int> _diagonal_positions;
+
+        double _exact_flow;
+        double _exact_time;
+        double _relative_error; //0 se il flusso esatto e' nullo
+
+    public:
+        ElectricalSolver();
+
+        inline ElectricalOption &getOption()
+        {
+            return this->_option;
+        }
+
+        void dispose();
+
+        void reset();
+
+        void solver();
+
+        void setArguments(map<string, string> &optset);
+
+        void printInput(ostream &stream);
+
+        void printOutput(ostream &stream);
+
+        inline bool hasEdgeFlows()
+        {
+            return true;
+        }
+
+        inline void printStatistic(ostream &stream)
+        {
+            printStatisticInternal(stream, false, true, true);
+        }
+
+    private:
+        void buildCircuit();
+        void updateResiduals();
+        bool hasResidualPath();
+        void updateLaplacian(vector<double> &resistances);
+        double augment(vector<double> &currents, double scale);
+        void pushWire(int w, double amount);
+
+        //capacita' residua del filo w nel verso della corrente
+        inline double getResidual(int w, double current) const
+        {
+            return _wire_residuals[2 * w + (current >= 0 ? 0 : 1)];
+        }
+    };
+}
+#endif
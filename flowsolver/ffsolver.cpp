@@ -52,7 +52,7 @@ bool BFS(vector<vector<double>> &resAdjMatrix, int &source, int &sink, vector<in
     return false;
 }
 
-int FordFulkerson(vector<vector<double>> &adjMatrix, int &source, int &sink)
+double FordFulkerson(vector<vector<double>> &adjMatrix, int &source, int &sink)
 {
     double maxflow = 0;
 
@@ -141,6 +141,7 @@ void FFSolver::printInput(ostream &stream)
     _network->populateAdjMatrix(adjMatrix, &source, &sink);
 
     stringstream ss;
+    printReductionOption(ss);
     ss << "AdjMatrix" << endl
        << "Source: " << source << endl
        << "Sink: " << sink << endl
@@ -178,6 +179,9 @@ void FFSolver::setArguments(map<string, string> &optset)
 
         int temp1, temp2;
 
+        if (parseReductionOption(opt))
+            continue;
+
         if (opt == "enable_log")
         {
             this->_enable_log = true;
@@ -8,6 +8,8 @@ using namespace flowsolver;
 using namespace core;
 using namespace graph;
 
+double FordFulkerson(vector<vector<double>> &adjMatrix, int &source, int &sink);
+
 class FFSolution : public Solution
 {
 private:
@@ -5,6 +5,7 @@
 #include "acosolver.h"
 #include "immunesolver.h"
 #include "ffsolver.h"
+#include "electricalsolver.h"
 
 namespace flowsolver
 {
@@ -12,7 +13,8 @@ namespace flowsolver
     {
         IMMUNE = 0,
         ACO = 1,
-        FORD_FUKERSON = 2
+        FORD_FUKERSON = 2,
+        ELECTRICAL = 3
     };
 
     FlowSolver *create_solver(FlowSolverMethod method)
@@ -29,6 +31,9 @@ namespace flowsolver
         case FORD_FUKERSON:
             solver = new FFSolver();
             break;
+        case ELECTRICAL:
+            solver = new ElectricalSolver();
+            break;
         }
         return solver;
     }
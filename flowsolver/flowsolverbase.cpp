@@ -22,6 +22,64 @@ FlowSolver::~FlowSolver()
         _logger.close();
 }
 
+void FlowSolver::setTopology(topology &topology)
+{
+    if (this->_state != SOLVER_READY)
+        throw "error";
+
+    //la rete del solver e' costruita sulla topologia ridotta, gli id originali sono conservati in _reduction
+    this->_reduction.reduce(topology, this->_reduction_option);
+    if (this->_reduction_option.remove_unreachable || this->_reduction_option.series_parallel)
+        print(this->_reduction.print(), true);
+
+    buildNetwork(this->_network, this->_reduction.getTopology());
+}
+
+void FlowSolver::restoreFlows(topology &original)
+{
+    this->_reduction.restoreFlows(this->_network->getTopology(), original);
+}
+
+void FlowSolver::restoreCut(network_cut &cut, vector<network_edgekey> &edges)
+{
+    network_index &index = this->_network->getIndex();
+    for (int w = 0; w < cut.count_words; w++)
+    {
+        for (uint64_t bits = cut.mask[w]; bits != 0; bits &= bits - 1)
+        {
+            int e = (w << 6) + __builtin_ctzll(bits);
+            this->_reduction.restoreEdge(network_edgekey(index.tails[e] - 2, index.heads[e] - 2), edges);
+        }
+    }
+}
+
+string FlowSolver::restorePath(const int *path, int size)
+{
+    if (path == nullptr)
+        return graph::to_string(path, size);
+
+    vector<int> nodes;
+    this->_reduction.restorePath(path, size, nodes);
+    return graph::to_string(nodes.data(), nodes.size());
+}
+
+bool FlowSolver::parseReductionOption(const string &opt)
+{
+    if (opt == "reduce_unreachable")
+        this->_reduction_option.remove_unreachable = true;
+    else if (opt == "reduce_series_parallel")
+        this->_reduction_option.series_parallel = true;
+    else
+        return false;
+    return true;
+}
+
+void FlowSolver::printReductionOption(ostream &stream)
+{
+    stream << "Reduce Unreachable: " << this->_reduction_option.remove_unreachable << endl
+           << "Reduce Series/Parallel: " << this->_reduction_option.series_parallel << endl;
+}
+
 void FlowSolver::internalReset()
 {
     this->_network->reset();
@@ -42,7 +100,7 @@ void FlowSolver::clearStatistics()
     this->_statistics.clear();
 }
 
-void FlowSolver::printStatisticInternal(ostream &out, bool print_mutation, bool print_topology, bool print_generic)
+void FlowSolver::printStatisticInternal(ostream &out, bool print_mutation, bool print_topology, bool print_generic, bool print_convergence)
 {
     out << "Interation;Time (ms);Best Fitness;Increment Best Fitness(%);Avg Fitness;Discarted";
     if (print_topology)
@@ -52,6 +110,8 @@ void FlowSolver::printStatisticInternal(ostream &out, bool print_mutation, bool
     out << ";Solution";
     if (print_generic)
         out << ";Alfa;Beta;Gamma";
+    if (print_convergence)
+        out << ";Branching;Restarts;IterationsToBest";
     out << endl;
 
     int collection_size = this->_statistics.size();
@@ -101,6 +161,13 @@ void FlowSolver::printStatisticInternal(ostream &out, bool print_mutation, bool
                 << ";" << core::to_string_format(stat->beta)
                 << ";" << core::to_string_format(stat->gamma);
         }
+        if (print_convergence)
+        {
+            out
+                << ";" << core::to_string_format(stat->branching)
+                << ";" << core::to_string_format(stat->restarts)
+                << ";" << core::to_string_format(stat->iterations_to_best);
+        }
         out << endl;
     }
 }
@@ -119,6 +186,9 @@ string to_string(statistic *source)
        << "Alfa: " << core::to_string_format(source->alfa) << endl
        << "Beta: " << core::to_string_format(source->beta) << endl
        << "Gamma: " << core::to_string_format(source->gamma) << endl
+       << "Branching: " << core::to_string_format(source->branching) << endl
+       << "Restarts: " << core::to_string_format(source->restarts) << endl
+       << "Iterations to best: " << core::to_string_format(source->iterations_to_best) << endl
        << "BEST" << endl
        << source->output->toString() << endl;
     return ss.str();
@@ -4,6 +4,8 @@
 
 #include "..\core\core.h"
 #include "..\network\network.h"
+#include "..\network\reduction.h"
+#include "..\network\distance.h"
 
 namespace flowsolver
 {
@@ -39,6 +41,9 @@ namespace flowsolver
     class Solution
     {
     public:
+        //le statistiche cancellano le soluzioni tramite il puntatore base
+        virtual ~Solution() {}
+
         virtual double getFitness() = 0;
         virtual string toString(bool compact = false) = 0;
         virtual bool isBest(Solution *solution) = 0;
@@ -60,6 +65,9 @@ namespace flowsolver
         double beta = 0;
         double gamma = 0;
         int invalid = 0;
+        double branching = 0;       //fattore di ramificazione del ferormone
+        int restarts = 0;           //reinizializzazioni del ferormone fino a questa iterazione
+        int iterations_to_best = 0; //iterazione in cui e' stata trovata la soluzione migliore
 
         inline ~s_statistic()
         {
@@ -80,6 +88,8 @@ namespace flowsolver
 
         //Input
         graph::network *_network;
+        graph::topology_reduction _reduction;
+        graph::reduction_option _reduction_option;
         bool _enable_log;
         ofstream _logger;
 
@@ -93,7 +103,8 @@ namespace flowsolver
 
     public:
         FlowSolver();
-        ~FlowSolver();
+        //i solver vengono cancellati anche tramite il puntatore base, le isole ACO comprese
+        virtual ~FlowSolver();
 
         inline SolverState getState() const
         {
@@ -105,11 +116,25 @@ namespace flowsolver
             return this->_random;
         }
 
-        inline void setTopology(graph::topology &topology)
+        void setTopology(graph::topology &topology);
+
+        void restoreFlows(graph::topology &original);
+
+        //true se il solver scrive il flusso sugli archi della rete, altrimenti restoreFlows copia zeri
+        virtual bool hasEdgeFlows()
+        {
+            return false;
+        }
+
+        //archi originali del taglio trovato sulla rete ridotta
+        void restoreCut(graph::network_cut &cut, vector<graph::network_edgekey> &edges);
+
+        //cammino della rete ridotta riportato sui nodi originali
+        string restorePath(const int *path, int size);
+
+        inline graph::topology_reduction &getReduction()
         {
-            if (this->_state != SOLVER_READY)
-                throw "error";
-            buildNetwork(this->_network, topology);
+            return this->_reduction;
         }
 
         inline void setLogFile(string &filename)
@@ -178,9 +203,12 @@ namespace flowsolver
         }
 
     protected:
+        //opzioni di riduzione comuni a tutti i solver, ritorna true se opt e' una di queste
+        bool parseReductionOption(const string &opt);
+        void printReductionOption(ostream &stream);
         void internalReset();
         void clearStatistics();
-        void printStatisticInternal(ostream &stream, bool print_mutation, bool print_topology, bool print_generic);
+        void printStatisticInternal(ostream &stream, bool print_mutation, bool print_topology, bool print_generic, bool print_convergence = false);
     };
 }
 #endif
\ No newline at end of file
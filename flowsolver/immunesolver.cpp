@@ -49,21 +49,76 @@ void flowsolver::copy(ImmuneCandidate *source, ImmuneCandidate *target)
 
 ImmuneSolver::ImmuneSolver(/* args */)
 {
+    _population = nullptr;
+    _current_population_size = 0;
+    _front = 0;
 }
 
 void ImmuneSolver::dispose()
 {
     this->internalReset();
     _fitness_buffer.clear();
-    delete[] _population;
+    releasePopulation(_buffers[0]);
+    releasePopulation(_buffers[1]);
+    _population = nullptr;
     delete _network;
 }
 
+void ImmuneSolver::allocatePopulation(immune_population &population, int capacity)
+{
+    network_index &index = _network->getIndex();
+    int node_size = _network->countNodes();
+    vector<int> ids(node_size);
+    _network->populateNodeIds(ids.data(), 0, false);
+    int max_id = 0;
+    for (auto &&id : ids)
+        max_id = MAX(max_id, GET_NODE_NORMAL_ID(id));
+
+    int side_words = BITMAP_WORDS(max_id + 1);
+    int cut_words = BITMAP_WORDS(index.count_edges);
+
+    releasePopulation(population);
+    population.capacity = capacity;
+    population.candidates = new ImmuneCandidate[capacity];
+    population.nodes.assign((size_t)capacity * node_size, 0);
+    population.sides.assign((size_t)capacity * side_words, 0);
+    population.masks.assign((size_t)capacity * cut_words, 0);
+    for (int i = 0; i < capacity; i++)
+    {
+        ImmuneCandidate &candidate = population.candidates[i];
+        candidate.partition.attach(&population.nodes[(size_t)i * node_size], node_size, &population.sides[(size_t)i * side_words], side_words);
+        candidate.cut.attach(&population.masks[(size_t)i * cut_words], cut_words);
+    }
+}
+
+void ImmuneSolver::releasePopulation(immune_population &population)
+{
+    delete[] population.candidates;
+    population.candidates = nullptr;
+    population.capacity = 0;
+    population.nodes.clear();
+    population.sides.clear();
+    population.masks.clear();
+}
+
+void ImmuneSolver::swapPopulation(int size)
+{
+    _front = 1 - _front;
+    _population = _buffers[_front].candidates;
+    _current_population_size = size;
+}
+
 void ImmuneSolver::initializePopulation()
 {
     int size = _option.population_size;
 
-    _population = new ImmuneCandidate[size];
+    //la popolazione piu' grande e' quella con i cloni
+    int capacity = size * (1 + _option.cloning_factor);
+    allocatePopulation(_buffers[0], capacity);
+    allocatePopulation(_buffers[1], capacity);
+    _front = 0;
+    _population = _buffers[_front].candidates;
+
     generateCandidate(_population, 0, size);
     _current_population_size = size;
     _current_interation = 0;
@@ -76,15 +131,15 @@ void ImmuneSolver::computeFitness()
     statistic *stat = _statistics.back();
     ImmuneCandidate *best_candidate = &_population[0];
 
+    //le capacita' sono gia' aggiornate: i nuovi candidati le ricevono da computeNetworkCuts a blocchi
+    //di NETWORK_CUT_LANES, cloni e copie le ereditano e le mutazioni le aggiornano arco per arco in
+    //updateNetworkCut. Resta -1 solo per i tagli non validi, che non entrano nella riduzione
+
+    //la riduzione resta in ordine, a parita' vince il primo candidato
     int k = 0;
     for (int i = 0; i < _current_population_size; i++)
     {
         ImmuneCandidate *candidate = &_population[i];
-        if (!IS_VALID_CUT_CAPACITY(candidate->cut_capacity))
-        {
-            candidate->cut_capacity = _network->computeCutCapacity(candidate->cut);
-        }
-
         if (IS_VALID_CUT_CAPACITY(candidate->cut_capacity))
         {
             avg_fitness += candidate->cut_capacity;
@@ -105,6 +160,8 @@ void ImmuneSolver::computeFitness()
 
     ImmuneSolution *solution = new ImmuneSolution();
     solution->extract(best_candidate);
+    if (best_candidate->cut.is_valid)
+        restoreCut(best_candidate->cut, solution->getOriginalCut());
     stat->output = solution;
 
     if (_best_result == nullptr || stat->fitness < _best_result->fitness)
@@ -139,12 +196,29 @@ int ImmuneSolver::generateCandidate(ImmuneCandidate *population, int start, int
         network_partition *partition = &(population[i].partition);
         partition->copyFrom(v, node_size, splitter);
 
-        network_cut *cut = &(population[i].cut);
-        _network->computeNetworkCut(partition, cut);
-
         count++;
     }
     delete[] v;
+
+    //le estrazioni sono in serie e costano O(n) per candidato, i tagli si calcolano in parallelo a
+    //blocchi di NETWORK_CUT_LANES candidati con un solo passaggio sugli archi per blocco
+    int count_blocks = (lenght + NETWORK_CUT_LANES - 1) / NETWORK_CUT_LANES;
+    _pool->run(count_blocks, [&](int block, int thread)
+               {
+                   int first = start + block * NETWORK_CUT_LANES;
+                   int size = MIN(NETWORK_CUT_LANES, end - first);
+                   network_partition *partitions[NETWORK_CUT_LANES] = {};
+                   network_cut *cuts[NETWORK_CUT_LANES] = {};
+                   double capacities[NETWORK_CUT_LANES] = {};
+                   for (int j = 0; j < size; j++)
+                   {
+                       partitions[j] = &population[first + j].partition;
+                       cuts[j] = &population[first + j].cut;
+                   }
+                   _network->computeNetworkCuts(partitions, cuts, size, capacities, _workers[thread].lanes);
+                   for (int j = 0; j < size; j++)
+                       population[first + j].cut_capacity = capacities[j];
+               });
     return count;
 }
 
@@ -175,7 +249,7 @@ void ImmuneSolver::cloningOperator()
 {
     double cloning_factor = _option.cloning_factor;
     int sizePC = _current_population_size * (1 + cloning_factor);
-    ImmuneCandidate *populationC = new ImmuneCandidate[sizePC];
+    ImmuneCandidate *populationC = _buffers[1 - _front].candidates;
 
     for (int i = 0, k = 0; i < _current_population_size; i++)
     {
@@ -186,10 +260,7 @@ void ImmuneSolver::cloningOperator()
         }
     }
 
-    delete[] _population;
-
-    _current_population_size = sizePC;
-    _population = populationC;
+    swapPopulation(sizePC);
 }
 
 double ImmuneSolver::computeMutationRate()
@@ -246,31 +317,95 @@ void ImmuneSolver::hypermutationOperator()
     stat->mutation_probability = SATURATE(p, 0.99, 0.01);
     stat->mutation_count = 0;
 
-    for (int i = 0; i < _current_population_size; i++)
+    //i semi sono estratti in ordine, cosi' il risultato non dipende dal numero di thread
+    int size = _current_population_size;
+    _seeds.resize(size);
+    _mutations.assign(size, 0);
+    for (int i = 0; i < size; i++)
+        _seeds[i] = _random->generator()();
+
+    //i partner del crossover sono gli originali, che in questa fase non vengono modificati
+    _parents.clear();
+    for (int i = 0; i < size; i++)
     {
-        ImmuneCandidate &source = _population[i];
-        if (source.is_clone)
-        {
-            int mutation_count = 0;
-            if (_option.mutation_operator == MUTATION_OPERATOR_SHUFFLE)
-            {
-                mutation_count = shuffle_partition(&source.partition, p, _option.probs_mutation_partition_size, _option.min_partition_size, _random);
-            }
-            else if (_option.mutation_operator == MUTATION_OPERATOR_CROSS_OVER)
-            {
-            }
+        if (!_population[i].is_clone)
+            _parents.push_back(i);
+    }
 
-            if (mutation_count > 0)
-            {
-                source.mutation += mutation_count;
-                source.is_mutate = true;
-                source.cut_capacity = -1;
-                _network->computeNetworkCut(&source.partition, &source.cut);
+    _pool->run(size, [&](int i, int thread)
+               {
+                   ImmuneCandidate &source = _population[i];
+                   if (!source.is_clone)
+                       return;
+
+                   immune_worker &worker = _workers[thread];
+                   worker.random.seed(_seeds[i]);
+
+                   int mutation_count = 0;
+                   worker.old_sides.assign(source.partition.sides, source.partition.sides + source.partition.count_words);
+                   if (_option.mutation_operator == MUTATION_OPERATOR_SHUFFLE)
+                   {
+                       mutation_count = shuffle_partition(&source.partition, p, _option.probs_mutation_partition_size, _option.min_partition_size, &worker.random);
+                   }
+                   else if (_option.mutation_operator == MUTATION_OPERATOR_CROSS_OVER)
+                   {
+                       mutation_count = crossOver(source, worker, p);
+                   }
+
+                   if (mutation_count > 0)
+                   {
+                       source.mutation += mutation_count;
+                       source.is_mutate = true;
+                       _network->updateNetworkCut(&source.partition, worker.old_sides.data(), &source.cut, source.cut_capacity);
+                   }
+                   _mutations[i] = mutation_count;
+               });
+
+    for (int i = 0; i < size; i++)
+        stat->mutation_count += _mutations[i];
+}
+
+int ImmuneSolver::crossOver(ImmuneCandidate &source, immune_worker &worker, double p)
+{
+    if (_parents.empty())
+        return 0;
+
+    ImmuneCandidate &partner = _population[_parents[worker.random.getInt({0, (int)_parents.size() - 1})]];
+    int words = source.partition.count_words;
+    worker.mask.assign(words, 0);
+    uint64_t *mask = worker.mask.data();
 
-                stat->mutation_count += mutation_count;
+    if (_option.cross_over == CROSS_OVER_UNIFORM)
+    {
+        //l'AND di k parole casuali ha ogni bit acceso con probabilita' 2^-k, circa p
+        p = SATURATE(p, 0.5, 1e-6);
+        int k = MAX(1, (int)round(-log2(p)));
+        for (int w = 0; w < words; w++)
+        {
+            uint64_t bits = ~0ULL;
+            for (int j = 0; j < k; j++)
+                bits &= ((uint64_t)worker.random.generator()() << 32) | worker.random.generator()();
+            mask[w] = bits;
+        }
+    }
+    else
+    {
+        //il clone riscrive il proprio confine con i lati del partner: i nodi presi sono gli
+        //estremi dei suoi archi di taglio, il resto della partizione resta quello del genitore
+        network_index &index = _network->getIndex();
+        network_cut &cut = source.cut;
+        for (int w = 0; w < cut.count_words; w++)
+        {
+            for (uint64_t bits = cut.mask[w]; bits != 0; bits &= bits - 1)
+            {
+                int e = (w << 6) + __builtin_ctzll(bits);
+                mask[BITMAP_WORD(index.tails[e])] |= BITMAP_BIT(index.tails[e]);
+                mask[BITMAP_WORD(index.heads[e])] |= BITMAP_BIT(index.heads[e]);
             }
         }
     }
+
+    return crossover_partition(&source.partition, &partner.partition, mask, _option.min_partition_size);
 }
 
 typedef struct
@@ -320,7 +455,7 @@ void ImmuneSolver::selectionOperator()
 
     int count_population = 0;
     int population_size = _option.population_size;
-    ImmuneCandidate *population = new ImmuneCandidate[population_size];
+    ImmuneCandidate *population = _buffers[1 - _front].candidates;
     for (int i = 0; i < list_size && count_population < population_size; i++)
     {
         CandidatePointer &pointer = list[i];
@@ -339,16 +474,14 @@ void ImmuneSolver::selectionOperator()
     }
 
     delete[] list;
-    delete[] _population;
-
-    _population = population;
-    _current_population_size = count_population;
+    swapPopulation(count_population);
 }
 
 void ImmuneSolver::reset()
 {
     this->internalReset();
-    delete[] _population;
+    releasePopulation(_buffers[0]);
+    releasePopulation(_buffers[1]);
     _population = nullptr;
     _current_population_size = 0;
     _fitness_buffer.clear();
@@ -369,6 +502,11 @@ void ImmuneSolver::solver()
     double executive_time = 0;
     double global_executive_time = 0;
 
+    if (_option.seed >= 0)
+        _random->seed(_option.seed);
+    _pool = new ThreadPool(_option.threads);
+    _workers.assign(_pool->size(), immune_worker());
+
     statistic *stat;
     {
         stat = new statistic();
@@ -437,6 +575,10 @@ void ImmuneSolver::solver()
                          false);
     }
 
+    delete _pool;
+    _pool = nullptr;
+    _workers.clear();
+
     this->_end_timestamp = GET_CURRENT_TIMESTAMP;
     this->_state = SOLVER_COMPUTED;
 
@@ -457,6 +599,9 @@ void ImmuneSolver::setArguments(map<string, string> &optset)
         string opt = pair.first;
         string &optarg = pair.second;
 
+        if (parseReductionOption(opt))
+            continue;
+
         int temp1, temp2;
         if (opt == "age_range")
         {
@@ -497,6 +642,32 @@ void ImmuneSolver::setArguments(map<string, string> &optset)
         {
             _option.min_partition_size = stoi(optarg);
         }
+        else if (opt == "mutation_operator")
+        {
+            if (optarg == "shuffle")
+                _option.mutation_operator = MUTATION_OPERATOR_SHUFFLE;
+            else if (optarg == "crossover")
+                _option.mutation_operator = MUTATION_OPERATOR_CROSS_OVER;
+            else
+                throw "mutation operator is not valid";
+        }
+        else if (opt == "cross_over")
+        {
+            if (optarg == "uniform")
+                _option.cross_over = CROSS_OVER_UNIFORM;
+            else if (optarg == "cut")
+                _option.cross_over = CROSS_OVER_CUT;
+            else
+                throw "crossover type is not valid";
+        }
+        else if (opt == "threads")
+        {
+            _option.threads = stoi(optarg);
+        }
+        else if (opt == "seed")
+        {
+            _option.seed = stol(optarg);
+        }
         else if (opt == "enable_log")
         {
             this->_enable_log = true;
@@ -518,7 +689,11 @@ void ImmuneSolver::printInput(ostream &stream)
            << "Probs mutation partition size: " << _option.probs_mutation_partition_size << endl
            << "Rho: " << _option.rho << endl
            << "Mutation operator: " << _option.mutation_operator << endl
-           << "Min partition size: " << _option.min_partition_size << endl;
+           << "Cross over: " << (_option.cross_over == CROSS_OVER_UNIFORM ? "uniform" : "cut") << endl
+           << "Min partition size: " << _option.min_partition_size << endl
+           << "Threads: " << _option.threads << endl
+           << "Seed: " << _option.seed << endl;
+    printReductionOption(stream);
 
     stream << "TOPOLOGY" << endl
            << _network->generateMATLABScript(true, false, false) << endl;
@@ -29,18 +29,25 @@ namespace flowsolver
     {
     private:
         ImmuneCandidate _candidate;
+        vector<graph::network_edgekey> _original_cut; //archi del taglio con gli id della topologia originale
 
     public:
         inline ImmuneCandidate &getCandidate()
         {
             return _candidate;
         }
+        inline vector<graph::network_edgekey> &getOriginalCut()
+        {
+            return _original_cut;
+        }
         inline string toString(bool compact = false)
         {
+            if (!_candidate.cut.is_valid)
+                return compact ? graph::to_string(_candidate.cut) : to_string(_candidate, -1);
             if (compact)
-                return graph::to_string(_candidate.cut);
+                return graph::to_string(_original_cut);
             else
-                return to_string(_candidate, -1);
+                return to_string(_candidate, -1) + "\tOriginal Cut: " + graph::to_string(_original_cut) + "\n";
         }
         inline void extract(ImmuneCandidate *candidate)
         {
@@ -62,6 +69,35 @@ namespace flowsolver
         MUTATION_OPERATOR_CROSS_OVER = 1
     };
 
+    //il clone prende dal partner il lato dei nodi scelti dalla maschera
+    enum CrossOverType
+    {
+        CROSS_OVER_UNIFORM = 0, //nodi casuali, circa uno ogni 1 / tasso di mutazione
+        CROSS_OVER_CUT = 1      //estremi degli archi del taglio del clone
+    };
+
+    //popolazione in blocchi a passo fisso: il candidato i usa nodes[i * node_stride],
+    //sides[i * side_words] e masks[i * cut_words]. Partizioni e tagli dei candidati puntano
+    //nell'arena, quindi copiare un candidato e' una memcpy dei suoi blocchi
+    typedef struct s_immune_population
+    {
+        ImmuneCandidate *candidates = nullptr;
+        vector<int> nodes;
+        vector<uint64_t> sides;
+        vector<uint64_t> masks;
+        int capacity = 0;
+    } immune_population;
+
+    //buffer locali di un thread. Il generatore viene riseminato per ogni candidato con un seme
+    //estratto in ordine dal generatore del solver, cosi' il risultato non dipende dai thread
+    typedef struct s_immune_worker
+    {
+        core::RandomNumberGenerator random;
+        vector<uint64_t> old_sides; //lato S della partizione prima della mutazione
+        vector<uint64_t> lanes;     //lati trasposti per la valutazione a blocchi
+        vector<uint64_t> mask;      //nodi che il crossover prende dal partner
+    } immune_worker;
+
     typedef struct s_immune_option
     {
         int population_size = 100;
@@ -75,6 +111,9 @@ namespace flowsolver
         int min_partition_size = 2;
         core::rangedouble regression_stable_interval = core::rangedouble(-0.01, 0.01);
         MutationOperatorType mutation_operator = MUTATION_OPERATOR_SHUFFLE;
+        CrossOverType cross_over = CROSS_OVER_UNIFORM;
+        int threads = 0;
+        long seed = -1;
     } ImmuneOption;
 
     class ImmuneSolver : public FlowSolver
@@ -82,11 +121,22 @@ namespace flowsolver
     private:
         ImmuneCandidate *_population;
         int _current_population_size;
+
+        //clonazione e selezione scrivono nel buffer libero e poi i due buffer si scambiano
+        immune_population _buffers[2];
+        int _front;
         core::NumericBuffer _fitness_buffer;
         ImmuneOption _option;
 
         int _count_stable_mutation_rate = 0;
 
+        //i candidati sono indipendenti: valutazione, generazione e mutazione girano sul pool
+        core::ThreadPool *_pool = nullptr;
+        vector<immune_worker> _workers;
+        vector<unsigned int> _seeds;
+        vector<int> _mutations;
+        vector<int> _parents; //candidati non clonati, partner del crossover
+
     public:
         ImmuneSolver();
 
@@ -108,6 +158,10 @@ namespace flowsolver
         }
 
     private:
+        void allocatePopulation(immune_population &population, int capacity);
+        void releasePopulation(immune_population &population);
+        void swapPopulation(int size);
+
         void initializePopulation();
         void computeFitness();
         void incrementAge();
@@ -116,6 +170,7 @@ namespace flowsolver
         void selectionOperator();
 
         int generateCandidate(ImmuneCandidate *population, int start, int lenght);
+        int crossOver(ImmuneCandidate &source, immune_worker &worker, double p);
         void clone(ImmuneCandidate *source, ImmuneCandidate *target);
         double computeMutationRate();
     };
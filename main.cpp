@@ -161,6 +161,160 @@ ShellCommandResult command_network_print(Shell *shell, shell_function_argument &
     return SHELL_COMMAND_SUCCESS;
 }
 
+network_node *select_uniform_node(network *, network_node *source, network_path &, void *arg)
+{
+    RandomNumberGenerator *random = (RandomNumberGenerator *)arg;
+    int n = source->next.size();
+    return n > 0 ? source->next[random->getInt({0, n - 1})] : nullptr;
+}
+
+ShellCommandResult command_network_benchmark(Shell *shell, shell_function_argument &arg)
+{
+    shell_context *context = (shell_context *)arg.context;
+    if (context->network == nullptr)
+    {
+        return SHELL_COMMAND_ERROR;
+    }
+
+    long hops = 1000000;
+    int sweeps = 1000;
+    for (auto &&pair : *arg.optset)
+    {
+        if (pair.first == "hops")
+            hops = stol(pair.second);
+        else if (pair.first == "sweeps")
+            sweeps = stoi(pair.second);
+    }
+
+    network *net = context->network;
+    RandomNumberGenerator *random = context->random;
+    int max_size = net->countEdges();
+
+    //cammini casuali uniformi con le due versioni di navigate
+    auto select = [&](network_node *source, network_path &)
+    {
+        int n = source->next.size();
+        return n > 0 ? source->next[random->getInt({0, n - 1})] : nullptr;
+    };
+
+    long count_function = 0, count_template = 0;
+    double time_function, time_template;
+
+    TIMESTAMP start = GET_CURRENT_TIMESTAMP;
+    while (count_function < hops)
+    {
+        network_path p = net->navigate(select_uniform_node, random, max_size, false);
+        count_function += MAX((int)p->size() - 1, 1);
+        deletePath(p);
+    }
+    TIMESTAMP end = GET_CURRENT_TIMESTAMP;
+    TIMESTAMP_ELAPSED_MS(start, end, time_function);
+
+    start = GET_CURRENT_TIMESTAMP;
+    while (count_template < hops)
+    {
+        network_path p = net->navigate(select, max_size, false);
+        count_template += MAX((int)p->size() - 1, 1);
+        deletePath(p);
+    }
+    end = GET_CURRENT_TIMESTAMP;
+    TIMESTAMP_ELAPSED_MS(start, end, time_template);
+
+    *arg.output << "Function pointer: " << (long)(count_function / time_function * 1000.0) << " hops/s" << endl
+                << "Template: " << (long)(count_template / time_template * 1000.0) << " hops/s" << endl;
+
+    //passate su tutti gli archi: ciclo sulla mappa della topologia contro i kernel sugli array per indice
+    topology &edges = net->getTopology();
+    int m = net->countEdges();
+    vector<double> tau(m), flows(m);
+    vector<int> visited(m), counters(m);
+    for (int i = 0; i < m; i++)
+    {
+        tau[i] = net->getEdge(i).tau;
+        flows[i] = net->getEdge(i).flow;
+        visited[i] = i % 10 == 0;
+        counters[i] = 1 + i % 7;
+    }
+
+    double checksum = 0;
+    double time_map[3], time_kernel[3][3];
+    start = GET_CURRENT_TIMESTAMP;
+    for (int r = 0; r < sweeps; r++)
+    {
+        int i = 0;
+        for (auto &&edge : edges)
+        {
+            tau[i] = 0.5 * edge.second.tau + (visited[i] == 1 ? 5.0 / (double)edge.second.counter : 0.0);
+            i++;
+        }
+    }
+    end = GET_CURRENT_TIMESTAMP;
+    TIMESTAMP_ELAPSED_MS(start, end, time_map[0]);
+
+    start = GET_CURRENT_TIMESTAMP;
+    for (int r = 0; r < sweeps; r++)
+    {
+        for (auto &&edge : edges)
+            edge.second.tau = 1;
+    }
+    end = GET_CURRENT_TIMESTAMP;
+    TIMESTAMP_ELAPSED_MS(start, end, time_map[1]);
+
+    start = GET_CURRENT_TIMESTAMP;
+    for (int r = 0; r < sweeps; r++)
+    {
+        double sum = 0, min = INFINITY;
+        for (auto &&edge : edges)
+        {
+            sum += edge.second.flow;
+            min = MIN(min, edge.second.flow);
+        }
+        checksum += sum + min;
+    }
+    end = GET_CURRENT_TIMESTAMP;
+    TIMESTAMP_ELAPSED_MS(start, end, time_map[2]);
+
+    simd_level detected = detectSimdLevel();
+    for (int level = SIMD_SCALAR; level <= detected; level++)
+    {
+        setSimdLevel((simd_level)level);
+
+        start = GET_CURRENT_TIMESTAMP;
+        for (int r = 0; r < sweeps; r++)
+            evaporateDeposit(tau.data(), visited.data(), counters.data(), m, 1, 0.5, 5.0);
+        end = GET_CURRENT_TIMESTAMP;
+        TIMESTAMP_ELAPSED_MS(start, end, time_kernel[level][0]);
+
+        start = GET_CURRENT_TIMESTAMP;
+        for (int r = 0; r < sweeps; r++)
+            fillArray(tau.data(), m, 1);
+        end = GET_CURRENT_TIMESTAMP;
+        TIMESTAMP_ELAPSED_MS(start, end, time_kernel[level][1]);
+
+        start = GET_CURRENT_TIMESTAMP;
+        for (int r = 0; r < sweeps; r++)
+            checksum += sumArray(flows.data(), m) + minArray(flows.data(), m);
+        end = GET_CURRENT_TIMESTAMP;
+        TIMESTAMP_ELAPSED_MS(start, end, time_kernel[level][2]);
+    }
+    setSimdLevel(detected);
+
+    //il ferormone della rete e' stato sovrascritto dal benchmark
+    net->reset(false, false, true, false, false);
+
+    double scale = 1e6 / ((double)sweeps * m);
+    const char *names[] = {"Evaporate+deposit", "Reset", "Sum+min"};
+    for (int j = 0; j < 3; j++)
+    {
+        *arg.output << names[j] << ": map " << time_map[j] * scale << " ns/edge";
+        for (int level = SIMD_SCALAR; level <= detected; level++)
+            *arg.output << ", " << simdLevelName((simd_level)level) << " " << time_kernel[level][j] * scale << " ns/edge";
+        *arg.output << endl;
+    }
+    *arg.output << "Checksum: " << checksum << endl;
+    return SHELL_COMMAND_SUCCESS;
+}
+
 ShellCommandResult command_flowsolver_create(Shell *shell, shell_function_argument &arg)
 {
     shell_context *context = (shell_context *)arg.context;
@@ -179,8 +333,8 @@ ShellCommandResult command_flowsolver_create(Shell *shell, shell_function_argume
 
     FlowSolver *solver = create_solver(method);
 
-    solver->setTopology(context->network->getTopology());
     solver->setArguments(*arg.optset);
+    solver->setTopology(context->network->getTopology());
     context->flowsolver = solver;
     return SHELL_COMMAND_SUCCESS;
 }
@@ -268,6 +422,25 @@ ShellCommandResult command_flowsolver_export(Shell *shell, shell_function_argume
     return SHELL_COMMAND_SUCCESS;
 }
 
+ShellCommandResult command_flowsolver_restore(Shell *shell, shell_function_argument &arg)
+{
+    shell_context *context = (shell_context *)arg.context;
+    if (context->flowsolver == nullptr || context->network == nullptr)
+    {
+        return SHELL_COMMAND_ERROR;
+    }
+
+    if (!context->flowsolver->hasEdgeFlows())
+    {
+        *arg.output << "Il solver non calcola il flusso sugli archi" << endl;
+        return SHELL_COMMAND_ERROR;
+    }
+
+    context->flowsolver->restoreFlows(context->network->getTopology());
+    *arg.output << context->network->generateMATLABScript(true, true, false);
+    return SHELL_COMMAND_SUCCESS;
+}
+
 ShellCommandResult command_flowsolver_statistic(Shell *shell, shell_function_argument &arg)
 {
     shell_context *context = (shell_context *)arg.context;
@@ -313,6 +486,7 @@ Shell *create_shell(shell_context *context)
     shell->addCommand("network_pruning", command_network_pruning);
     shell->addCommand("network_export", command_network_export);
     shell->addCommand("network_print", command_network_print);
+    shell->addCommand("network_benchmark", command_network_benchmark);
 
     shell->addCommand("flowsolver_create", command_flowsolver_create);
     shell->addCommand("flowsolver_run", command_flowsolver_run);
@@ -322,6 +496,7 @@ Shell *create_shell(shell_context *context)
     shell->addCommand("flowsolver_reset", command_flowsolver_reset);
     shell->addCommand("flowsolver_statistic", command_flowsolver_statistic);
     shell->addCommand("flowsolver_best", command_flowsolver_best);
+    shell->addCommand("flowsolver_restore", command_flowsolver_restore);
     return shell;
 }
 
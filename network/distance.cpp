@@ -0,0 +1,215 @@
+#include "distance.h"
+
+using namespace graph;
+
+#define DISTANCE_SOURCE GET_NODE_NORMAL_ID(ID_NODE_SOURCE)
+#define DISTANCE_TARGET GET_NODE_NORMAL_ID(ID_NODE_TARGET)
+
+residual_distance::residual_distance()
+{
+    _index = nullptr;
+    _backward = false;
+    _unreachable = 0;
+}
+
+bool residual_distance::isForwardActive(int e)
+{
+    network_edge *edge = _index->edges[e];
+    return edge->enable && _index->tails[e] != _index->heads[e] && edge->getResidualCapacity() > 0;
+}
+
+bool residual_distance::isBackwardActive(int e)
+{
+    network_edge *edge = _index->edges[e];
+    return _backward && edge->enable && _index->tails[e] != _index->heads[e] && edge->flow > 0;
+}
+
+void residual_distance::build(network_index &index, bool backward)
+{
+    _index = &index;
+    _backward = backward;
+    int n = index.count_nodes;
+    int m = index.count_edges;
+
+    //nessun cammino semplice supera n - 1 archi
+    _unreachable = n;
+    _labels.assign(n, _unreachable);
+    _affected.assign(n, 0);
+    _forward_arcs.resize(m);
+    _backward_arcs.resize(m);
+    for (int e = 0; e < m; e++)
+    {
+        _forward_arcs[e] = isForwardActive(e);
+        _backward_arcs[e] = isBackwardActive(e);
+    }
+
+    _queue.clear();
+    _labels[DISTANCE_TARGET] = 0;
+    _queue.push_back(DISTANCE_TARGET);
+    for (size_t head = 0; head < _queue.size(); head++)
+    {
+        int v = _queue[head];
+        visitPredecessors(v, [&](int w)
+                          {
+                              if (_labels[w] == _unreachable)
+                              {
+                                  _labels[w] = _labels[v] + 1;
+                                  _queue.push_back(w);
+                              }
+                          });
+    }
+}
+
+bool residual_distance::hasSupport(int u)
+{
+    int label = _labels[u];
+    return visitSuccessors(u, [&](int x)
+                           { return !_affected[x] && _labels[x] == label - 1; });
+}
+
+int residual_distance::bestSuccessor(int u)
+{
+    int best = _unreachable;
+    visitSuccessors(u, [&](int x)
+                    {
+                        if (!_affected[x] && _labels[x] + 1 < best)
+                            best = _labels[x] + 1;
+                        return false;
+                    });
+    return best;
+}
+
+void residual_distance::setLabel(int u, int label)
+{
+    if (_labels[u] != label)
+    {
+        _labels[u] = label;
+        _changed.push_back(u);
+    }
+}
+
+void residual_distance::propagateIncrease()
+{
+    //i nodi senza un successore alla distanza precedente perdono l'etichetta, e con loro i
+    //predecessori che si appoggiavano solo su di loro
+    vector<int> affected;
+    for (size_t head = 0; head < _queue.size(); head++)
+    {
+        int u = _queue[head];
+        if (_affected[u] || u == DISTANCE_TARGET || _labels[u] == _unreachable || hasSupport(u))
+            continue;
+
+        _affected[u] = 1;
+        affected.push_back(u);
+        int label = _labels[u];
+        visitPredecessors(u, [&](int w)
+                          {
+                              if (!_affected[w] && _labels[w] == label + 1)
+                                  _queue.push_back(w);
+                          });
+    }
+    _queue.clear();
+    if (affected.empty())
+        return;
+
+    //le nuove etichette dei nodi colpiti si fissano in ordine crescente partendo dai bordi
+    typedef pair<int, int> entry;
+    priority_queue<entry, vector<entry>, greater<entry>> heap;
+    for (auto &&u : affected)
+    {
+        int label = bestSuccessor(u);
+        setLabel(u, label);
+        if (label < _unreachable)
+            heap.push({label, u});
+    }
+    while (!heap.empty())
+    {
+        entry top = heap.top();
+        heap.pop();
+        int u = top.second;
+        if (!_affected[u] || top.first != _labels[u])
+            continue;
+
+        _affected[u] = 0;
+        visitPredecessors(u, [&](int w)
+                          {
+                              if (_affected[w] && _labels[u] + 1 < _labels[w])
+                              {
+                                  setLabel(w, _labels[u] + 1);
+                                  heap.push({_labels[w], w});
+                              }
+                          });
+    }
+
+    //quelli rimasti non raggiungono piu' il target
+    for (auto &&u : affected)
+        _affected[u] = 0;
+}
+
+void residual_distance::propagateDecrease()
+{
+    for (size_t head = 0; head < _queue.size(); head++)
+    {
+        int v = _queue[head];
+        visitPredecessors(v, [&](int w)
+                          {
+                              if (w != DISTANCE_TARGET && _labels[v] + 1 < _labels[w])
+                              {
+                                  setLabel(w, _labels[v] + 1);
+                                  _queue.push_back(w);
+                              }
+                          });
+    }
+    _queue.clear();
+}
+
+const vector<int> &residual_distance::update(const int *edges, int size)
+{
+    _changed.clear();
+
+    //prima si tolgono gli archi spariti, poi si aggiungono quelli comparsi
+    _queue.clear();
+    for (int i = 0; i < size; i++)
+    {
+        int e = edges[i];
+        int a = _index->tails[e], b = _index->heads[e];
+        if (_forward_arcs[e] && !isForwardActive(e))
+        {
+            _forward_arcs[e] = 0;
+            _queue.push_back(a);
+        }
+        if (_backward_arcs[e] && !isBackwardActive(e))
+        {
+            _backward_arcs[e] = 0;
+            _queue.push_back(b);
+        }
+    }
+    propagateIncrease();
+
+    for (int i = 0; i < size; i++)
+    {
+        int e = edges[i];
+        int a = _index->tails[e], b = _index->heads[e];
+        if (!_forward_arcs[e] && isForwardActive(e))
+        {
+            _forward_arcs[e] = 1;
+            if (b != DISTANCE_SOURCE && a != DISTANCE_TARGET && _labels[b] + 1 < _labels[a])
+            {
+                setLabel(a, _labels[b] + 1);
+                _queue.push_back(a);
+            }
+        }
+        if (!_backward_arcs[e] && isBackwardActive(e))
+        {
+            _backward_arcs[e] = 1;
+            if (a != DISTANCE_SOURCE && b != DISTANCE_TARGET && _labels[a] + 1 < _labels[b])
+            {
+                setLabel(b, _labels[a] + 1);
+                _queue.push_back(b);
+            }
+        }
+    }
+    propagateDecrease();
+
+    return _changed;
+}
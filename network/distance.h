@@ -0,0 +1,109 @@
+#pragma once
+#ifndef _H_DISTANCE
+#define _H_DISTANCE
+
+#include "network.h"
+
+namespace graph
+{
+    //distanze esatte in numero di archi dal nodo al target nel grafo residuo, per id normale.
+    //Un arco u -> v e' attivo se ha capacita' residua, con backward anche l'arco inverso v -> u
+    //se porta flusso. Gli archi verso la sorgente non contano: le formiche non ci tornano.
+    //Lo stato degli archi viene fotografato in build() e update(), quindi le etichette restano
+    //coerenti con l'ultima fotografia anche se il flusso cambia nel frattempo.
+    class residual_distance
+    {
+    private:
+        network_index *_index;
+        bool _backward;
+        int _unreachable;
+        vector<int> _labels;
+        vector<char> _forward_arcs;  //arco e attivo da tails[e] a heads[e]
+        vector<char> _backward_arcs; //arco e attivo da heads[e] a tails[e]
+        vector<char> _affected;
+        vector<int> _queue;
+        vector<int> _changed;
+
+    public:
+        residual_distance();
+
+        //ricalcola tutte le etichette con una BFS all'indietro dal target
+        void build(network_index &index, bool backward);
+
+        //aggiorna le etichette dopo che il flusso degli archi indicati e' cambiato. Gli archi
+        //spariti possono solo allungare le distanze dei nodi che li usavano, quelli comparsi
+        //solo accorciarle. Ritorna i nodi con l'etichetta cambiata.
+        const vector<int> &update(const int *edges, int size);
+
+        inline int getLabel(int u) const
+        {
+            return _labels[u];
+        }
+
+        inline bool isReachable(int u) const
+        {
+            return _labels[u] < _unreachable;
+        }
+
+        inline int unreachable() const
+        {
+            return _unreachable;
+        }
+
+    private:
+        bool isForwardActive(int e);
+
+        bool isBackwardActive(int e);
+
+        //visit(x) per ogni arco attivo u -> x, si ferma quando visit ritorna true
+        template <typename Visitor>
+        inline bool visitSuccessors(int u, Visitor visit)
+        {
+            int source = GET_NODE_NORMAL_ID(ID_NODE_SOURCE);
+            for (int i = _index->out_offsets[u]; i < _index->out_offsets[u + 1]; i++)
+            {
+                int e = _index->out_edges[i];
+                if (_forward_arcs[e] && _index->heads[e] != source && visit(_index->heads[e]))
+                    return true;
+            }
+            for (int i = _index->in_offsets[u]; _backward && i < _index->in_offsets[u + 1]; i++)
+            {
+                int e = _index->in_edges[i];
+                if (_backward_arcs[e] && _index->tails[e] != source && visit(_index->tails[e]))
+                    return true;
+            }
+            return false;
+        }
+
+        //visit(w) per ogni arco attivo w -> v
+        template <typename Visitor>
+        inline void visitPredecessors(int v, Visitor visit)
+        {
+            if (v == GET_NODE_NORMAL_ID(ID_NODE_SOURCE))
+                return;
+            for (int i = _index->in_offsets[v]; i < _index->in_offsets[v + 1]; i++)
+            {
+                int e = _index->in_edges[i];
+                if (_forward_arcs[e])
+                    visit(_index->tails[e]);
+            }
+            for (int i = _index->out_offsets[v]; _backward && i < _index->out_offsets[v + 1]; i++)
+            {
+                int e = _index->out_edges[i];
+                if (_backward_arcs[e])
+                    visit(_index->heads[e]);
+            }
+        }
+
+        bool hasSupport(int u);
+
+        int bestSuccessor(int u);
+
+        void propagateIncrease();
+
+        void propagateDecrease();
+
+        void setLabel(int u, int label);
+    };
+}
+#endif
@@ -13,16 +13,22 @@ using namespace graph;
 
 string graph::to_string(const network_path &p)
 {
-    stringstream ss;
     if (p != emptyPath)
+        return graph::to_string(p->data(), p->size());
+    else
+        return graph::to_string(nullptr, 0);
+}
+
+string graph::to_string(const int *path, int size)
+{
+    stringstream ss;
+    if (path != nullptr)
     {
-        ss << "[" << p->size() << "](";
-        bool first = true;
-        for (auto &n : *p)
+        ss << "[" << size << "](";
+        for (int i = 0; i < size; i++)
         {
-            if (first)
-                first = false;
-            else
+            int n = path[i];
+            if (i > 0)
                 ss << ',';
             if (n == ID_NODE_TARGET)
                 ss << "t";
@@ -89,15 +95,41 @@ bool compareEdgeNodeById(edgenode_t &i, edgenode_t &j)
 
 network_cut::s_network_cut()
 {
+    mask = nullptr;
+    count_words = 0;
     count_size = 0;
     is_valid = false;
+    shared = false;
 }
 
 network_cut::~s_network_cut()
 {
-    if (edges != nullptr)
-        delete[] edges;
-    edges = nullptr;
+    if (!shared)
+        delete[] mask;
+    mask = nullptr;
+}
+
+void network_cut::attach(uint64_t *mask, int count_words)
+{
+    if (!shared)
+        delete[] this->mask;
+    this->mask = mask;
+    this->count_words = count_words;
+    this->shared = true;
+}
+
+void network_cut::clear(int count_edges)
+{
+    int words = BITMAP_WORDS(count_edges);
+    if (!shared && words != count_words)
+    {
+        delete[] mask;
+        mask = new uint64_t[words];
+        count_words = words;
+    }
+    memset(mask, 0, count_words * sizeof(uint64_t));
+    count_size = 0;
+    is_valid = false;
 }
 
 string graph::to_string(network_cut &cut)
@@ -106,11 +138,15 @@ string graph::to_string(network_cut &cut)
     ss << "(";
     if (cut.is_valid)
     {
-        for (int i = 0; i < cut.count_size; i++)
+        int k = 0;
+        for (int w = 0; w < cut.count_words; w++)
         {
-            if (i > 0)
-                ss << ",";
-            ss << std::to_string(cut.edges[i]);
+            for (uint64_t bits = cut.mask[w]; bits != 0; bits &= bits - 1)
+            {
+                if (k++ > 0)
+                    ss << ",";
+                ss << std::to_string((w << 6) + __builtin_ctzll(bits));
+            }
         }
     }
     else
@@ -123,52 +159,108 @@ string graph::to_string(network_cut &cut)
 
 void graph::copy(network_cut *source, network_cut *target)
 {
-    target->~s_network_cut();
-
-    target->is_valid = source->is_valid;
-    if (target->is_valid)
+    if (!target->shared && target->count_words != source->count_words)
     {
-        int n = source->count_size;
-        target->count_size = n;
-        target->edges = new int[n];
-        for (int i = 0; i < n; i++)
-            target->edges[i] = source->edges[i];
+        delete[] target->mask;
+        target->mask = source->count_words > 0 ? new uint64_t[source->count_words] : nullptr;
+        target->count_words = source->count_words;
     }
+    memcpy(target->mask, source->mask, source->count_words * sizeof(uint64_t));
+    target->count_size = source->count_size;
+    target->is_valid = source->is_valid;
 }
 
 network_partition::s_network_partition()
 {
+    nodes = nullptr;
+    sides = nullptr;
     size_S = 0;
     size_T = 0;
+    count_words = 0;
+    shared = false;
 }
 
 network_partition::~s_network_partition()
 {
-    delete[] this->nodes;
+    if (!shared)
+    {
+        delete[] this->nodes;
+        delete[] this->sides;
+    }
 }
 
-void network_partition::copyFrom(int *nodes, int size_node, int splitter)
+void network_partition::attach(int *nodes, int size_node, uint64_t *sides, int count_words)
 {
-    delete[] this->nodes;
+    if (!shared)
+    {
+        delete[] this->nodes;
+        delete[] this->sides;
+    }
+    this->nodes = nodes;
+    this->sides = sides;
+    this->size_S = 0;
+    this->size_T = size_node;
+    this->count_words = count_words;
+    this->shared = true;
+}
 
-    this->nodes = new int[size_node];
-    for (int i = 0; i < size_node; i++)
-        this->nodes[i] = nodes[i];
+void network_partition::copyFrom(int *nodes, int size_node, int splitter)
+{
+    if (!shared && size() != size_node)
+    {
+        delete[] this->nodes;
+        this->nodes = new int[size_node];
+    }
+    memcpy(this->nodes, nodes, size_node * sizeof(int));
     this->size_S = splitter;
     this->size_T = size_node - splitter;
+    updateSides();
+}
+
+void network_partition::updateSides()
+{
+    if (!shared)
+    {
+        int n = size();
+        int max_id = 0;
+        for (int i = 0; i < n; i++)
+            max_id = MAX(max_id, GET_NODE_NORMAL_ID(nodes[i]));
+
+        int words = BITMAP_WORDS(max_id + 1);
+        if (words != count_words)
+        {
+            delete[] sides;
+            sides = new uint64_t[words];
+            count_words = words;
+        }
+    }
+    memset(sides, 0, count_words * sizeof(uint64_t));
+    for (int i = 0; i < size_S; i++)
+    {
+        int u = GET_NODE_NORMAL_ID(nodes[i]);
+        sides[BITMAP_WORD(u)] |= BITMAP_BIT(u);
+    }
 }
 
 void graph::copy(network_partition *source, network_partition *target)
 {
-    target->~s_network_partition();
+    int n = source->size();
+    if (!target->shared && target->size() != n)
+    {
+        delete[] target->nodes;
+        target->nodes = new int[n];
+    }
+    if (!target->shared && target->count_words != source->count_words)
+    {
+        delete[] target->sides;
+        target->sides = new uint64_t[source->count_words];
+        target->count_words = source->count_words;
+    }
 
     target->size_S = source->size_S;
     target->size_T = source->size_T;
-
-    int n = source->size();
-    target->nodes = new int[n];
-    for (int i = 0; i < n; i++)
-        target->nodes[i] = source->nodes[i];
+    memcpy(target->nodes, source->nodes, n * sizeof(int));
+    memcpy(target->sides, source->sides, source->count_words * sizeof(uint64_t));
 }
 
 int graph::shuffle_partition(network_partition *partition, double mutation_rate, double p_change_size, int min_partition_size, RandomNumberGenerator *random)
@@ -186,9 +278,38 @@ int graph::shuffle_partition(network_partition *partition, double mutation_rate,
         partition->resize(splitter);
     }
 
+    partition->updateSides();
     return c;
 }
 
+int graph::crossover_partition(network_partition *partition, network_partition *partner, const uint64_t *mask, int min_partition_size)
+{
+    uint64_t *sides = partition->sides;
+    const uint64_t *other = partner->sides;
+    int words = MIN(partition->count_words, partner->count_words);
+
+    int size_S = 0, moved = 0;
+    for (int w = 0; w < words; w++)
+    {
+        uint64_t child = (sides[w] & ~mask[w]) | (other[w] & mask[w]);
+        size_S += __builtin_popcountll(child);
+        moved += __builtin_popcountll(child ^ sides[w]);
+    }
+
+    int n = partition->size();
+    if (moved == 0 || size_S < min_partition_size || n - size_S < min_partition_size)
+        return 0;
+
+    for (int w = 0; w < words; w++)
+        sides[w] = (sides[w] & ~mask[w]) | (other[w] & mask[w]);
+
+    //l'ordine dentro i lati non conta: i nodi di S tornano in testa
+    std::partition(partition->nodes, partition->nodes + n, [&](int id)
+                   { return partition->containsInS(id); });
+    partition->resize(size_S);
+    return moved;
+}
+
 network::network(RandomNumberGenerator *rand)
 {
     _s.id = ID_NODE_SOURCE;
@@ -237,31 +358,13 @@ double network::getFlow()
     return c;
 }
 
-network_path network::navigate(select_node_function select_node, void *arg, int max_size)
+network_path network::navigate(select_node_function select_node, void *arg, int max_size, bool update_counter)
 {
-    network_path p = createPath();
-    network_node *current_node = GET_NODE_SOURCE(this);
-    p->push_back(current_node->id);
-
-    int count = 0;
-    network_node *last_node;
-    while (!IS_NODE_TARGET(current_node->id) && (max_size <= 0 || count <= max_size))
+    auto select = [&](network_node *node, network_path &path)
     {
-        last_node = current_node;
-        current_node = select_node(this, current_node, p, arg);
-        if (current_node == nullptr)
-        {
-            break;
-        }
-
-        network_edge &edge = getEdge({last_node->id, current_node->id});
-        edge.counter++;
-        p->push_back(current_node->id);
-
-        count++;
-    }
-
-    return p;
+        return select_node(this, node, path, arg);
+    };
+    return navigate(select, max_size, update_counter);
 }
 
 int network::countEdges(network_path path)
@@ -377,30 +480,119 @@ network_path network::normalizePath(network_path path)
     return new_path;
 }
 
-void network::updateFlow(network_path path, double delta_flow)
+path_span network::normalizePath(const int *path, int size, path_arena &arena)
 {
-    int n = path->size();
-    for (int i = 0; i < n - 1; i++)
+    reset(false, false, false, true, false);
+
+    //il nodo gia' presente nel cammino chiude un ciclo: si tolgono i nodi aggiunti dopo di lui
+    int offset = arena.top();
+    for (int i = 0; i < size; i++)
     {
-        network_edge &edge = getEdge({path->at(i), path->at(i + 1)});
-        edge.flow += delta_flow;
+        network_node *node = getNode(path[i]);
+        if (node->color == NODE_WHITE)
+        {
+            node->color = NODE_GREEN;
+            arena.push(node->id);
+        }
+        else
+        {
+            while (arena.back() != node->id)
+            {
+                getNode(arena.back())->color = NODE_WHITE;
+                arena.pop();
+            }
+        }
     }
+    return arena.close(offset);
 }
 
-double network::getMinResidualCapacity(network_path path)
+double network::getResidualCapacity(int u, int v)
+{
+    int a = GET_NODE_NORMAL_ID(u), b = GET_NODE_NORMAL_ID(v);
+    int e = _index.findStep(a, b);
+    return e >= 0 ? getArcResidualCapacity(e, _index.tails[e] == a) : 0;
+}
+
+double network::getArcResidualCapacity(int e, bool forward)
+{
+    network_edge *edge = _index.edges[e];
+    int r = _index.reverse[e];
+    if (forward)
+        return edge->getResidualCapacity() + (r >= 0 ? _index.edges[r]->flow : 0);
+    return edge->flow + (r >= 0 ? _index.edges[r]->getResidualCapacity() : 0);
+}
+
+void network::pushFlow(int u, int v, double delta_flow)
+{
+    int a = GET_NODE_NORMAL_ID(u), b = GET_NODE_NORMAL_ID(v);
+    int e = _index.findStep(a, b);
+    if (e >= 0)
+        pushArcFlow(e, _index.tails[e] == a, delta_flow);
+}
+
+void network::pushArcFlow(int e, bool forward, double delta_flow)
+{
+    int to = forward ? e : _index.reverse[e];
+    int from = forward ? _index.reverse[e] : e;
+
+    //prima si annulla il flusso sull'arco inverso, il resto passa sull'arco diretto
+    if (from >= 0)
+    {
+        network_edge *edge = _index.edges[from];
+        double cancel = MIN(delta_flow, edge->flow);
+        edge->flow -= cancel;
+        delta_flow -= cancel;
+    }
+    if (to >= 0)
+        _index.edges[to]->flow += delta_flow;
+}
+
+void network::updateFlow(const int *path, int size, double delta_flow)
+{
+    for (int i = 0; i < size - 1; i++)
+        pushFlow(path[i], path[i + 1], delta_flow);
+}
+
+void network::updateFlow(const int *path, const int *arcs, int size, double delta_flow)
+{
+    for (int i = 0; i < size - 1; i++)
+        pushArcFlow(arcs[i], _index.tails[arcs[i]] == GET_NODE_NORMAL_ID(path[i]), delta_flow);
+}
+
+double network::getMinResidualCapacity(const int *path, int size)
 {
     double min = +INFINITY;
-    int n = path->size();
-    for (int i = 0; i < n - 1; i++)
+    for (int i = 0; i < size - 1; i++)
     {
-        network_edge &edge = getEdge({path->at(i), path->at(i + 1)});
-        double c = edge.getResidualCapacity();
+        double c = getResidualCapacity(path[i], path[i + 1]);
         if (c < min)
             min = c;
     }
     return min;
 }
 
+double network::getMinResidualCapacity(const int *path, const int *arcs, int size)
+{
+    double min = +INFINITY;
+    for (int i = 0; i < size - 1; i++)
+    {
+        double c = getArcResidualCapacity(arcs[i], _index.tails[arcs[i]] == GET_NODE_NORMAL_ID(path[i]));
+        if (c < min)
+            min = c;
+    }
+    return min;
+}
+
+void network::updateFlow(network_path path, double delta_flow)
+{
+    updateFlow(path->data(), path->size(), delta_flow);
+}
+
+double network::getMinResidualCapacity(network_path path)
+{
+    return getMinResidualCapacity(path->data(), path->size());
+}
+
 /*
 void network::updateAllEdges(network_path path, double delta_flow_path, double delta_tau_path, double delta_flow, double delta_tau)
 {
@@ -486,57 +678,179 @@ void network::populateNodeIds(int *v, int start, bool include_special_node)
 
 void network::computeNetworkCut(network_partition *partition, network_cut *cut_computed)
 {
-    cut_computed->~network_cut();
+    //un solo passaggio sugli array di code e teste: l'arco u -> v e' nel taglio se u e' in S e v in
+    //T, cioe' v non e' in S e non e' ne' la sorgente ne' il target (i loro bit sono sempre spenti)
+    const int *tails = _index.tails.data();
+    const int *heads = _index.heads.data();
+    const uint64_t *sides = partition->sides;
+    int target = GET_NODE_NORMAL_ID(ID_NODE_TARGET);
+
+    cut_computed->clear(_index.count_edges);
+    uint64_t *mask = cut_computed->mask;
+    int count = 0;
+    for (int e = 0; e < _index.count_edges; e++)
+    {
+        int u = tails[e], v = heads[e];
+        if ((sides[BITMAP_WORD(u)] & BITMAP_BIT(u)) && v > target && !(sides[BITMAP_WORD(v)] & BITMAP_BIT(v)))
+        {
+            mask[BITMAP_WORD(e)] |= BITMAP_BIT(e);
+            count++;
+        }
+    }
+    cut_computed->count_size = count;
+    cut_computed->is_valid = count > 1;
+}
 
-    int i = 0;
-    int n = partition->size();
-    vector<int> *edges = new vector<int>();
+void network::updateNetworkCut(network_partition *partition, const uint64_t *old_sides, network_cut *cut, double &capacity)
+{
+    const uint64_t *sides = partition->sides;
+    int target = GET_NODE_NORMAL_ID(ID_NODE_TARGET);
+
+    //con una capacita' valida in ingresso basta sommare gli archi che entrano nel taglio e togliere
+    //quelli che escono, altrimenti (taglio non valido) la somma si rifa' alla fine
+    bool incremental = IS_VALID_CUT_CAPACITY(capacity);
 
-    unordered_set<int> hash_s;
-    for (i = 0; i < partition->size_S; i++)
-        hash_s.insert(partition->nodes[i]);
-    unordered_set<int> hash_t;
-    for (; i < n; i++)
-        hash_t.insert(partition->nodes[i]);
-    /*
-    for (auto &&s : hash_s)
+    //riporta un arco incidente a un nodo spostato allo stato che gli da' la nuova partizione,
+    //un arco tra due nodi spostati viene visto due volte ma cambia solo la prima
+    auto refresh = [&](int e)
     {
-        for (auto &&t : hash_t)
+        int u = _index.tails[e], v = _index.heads[e];
+        bool in_cut = (sides[BITMAP_WORD(u)] & BITMAP_BIT(u)) && v > target && !(sides[BITMAP_WORD(v)] & BITMAP_BIT(v));
+        if (in_cut != cut->contains(e))
         {
-            network_edgekey key(s, t);
-            if (_topology.contains(key))
-            {
-                edges->push_back(key);
-            }
+            cut->mask[BITMAP_WORD(e)] ^= BITMAP_BIT(e);
+            cut->count_size += in_cut ? 1 : -1;
+            if (incremental)
+                capacity += in_cut ? _index.edges[e]->capacity : -_index.edges[e]->capacity;
         }
-    }*/
+    };
 
-    i = 0;
-    for (auto &&edge : _topology)
+    for (int w = 0; w < partition->count_words; w++)
     {
-        int s = edge.first.id1;
-        int t = edge.first.id2;
+        for (uint64_t moved = old_sides[w] ^ sides[w]; moved != 0; moved &= moved - 1)
+        {
+            int u = (w << 6) + __builtin_ctzll(moved);
+            for (int i = _index.out_offsets[u]; i < _index.out_offsets[u + 1]; i++)
+                refresh(_index.out_edges[i]);
+            for (int i = _index.in_offsets[u]; i < _index.in_offsets[u + 1]; i++)
+                refresh(_index.in_edges[i]);
+        }
+    }
+    cut->is_valid = cut->count_size > 1;
+
+    if (!cut->is_valid)
+        capacity = -1;
+    else if (!incremental)
+        capacity = computeCutCapacity(*cut);
+    else
+        capacity = SATURATE_MIN(capacity, 0); //le sottrazioni non scendono sotto zero per arrotondamento
+}
+
+void network::computeNetworkCuts(network_partition *const *partitions, network_cut *const *cuts, int count, double *capacities, vector<uint64_t> &lanes)
+{
+    if (count > NETWORK_CUT_LANES)
+        throw "too many partitions";
 
-        if (CONTAINS_SET(hash_s, s) && CONTAINS_SET(hash_t, t))
+    //popolazione trasposta: un uint64_t per nodo con il lato di ogni partizione
+    lanes.assign(_index.count_nodes, 0);
+    int sizes[NETWORK_CUT_LANES];
+    for (int j = 0; j < count; j++)
+    {
+        network_partition *partition = partitions[j];
+        for (int i = 0; i < partition->size_S; i++)
+            lanes[GET_NODE_NORMAL_ID(partition->nodes[i])] |= BITMAP_BIT(j);
+        cuts[j]->clear(_index.count_edges);
+        capacities[j] = 0;
+        sizes[j] = 0;
+    }
+
+    //l'arco u -> v e' nel taglio di tutte le partizioni con u in S e v in T: i bit accesi di
+    //lanes[u] & ~lanes[v], con v diverso da sorgente e target
+    const int *tails = _index.tails.data();
+    const int *heads = _index.heads.data();
+    const uint64_t *sides = lanes.data();
+    int target = GET_NODE_NORMAL_ID(ID_NODE_TARGET);
+    for (int e = 0; e < _index.count_edges; e++)
+    {
+        int v = heads[e];
+        if (v <= target)
+            continue;
+
+        uint64_t cut = sides[tails[e]] & ~sides[v];
+        if (cut == 0)
+            continue;
+
+        double capacity = _index.edges[e]->capacity;
+        uint64_t bit = BITMAP_BIT(e);
+        int word = BITMAP_WORD(e);
+        for (; cut != 0; cut &= cut - 1)
         {
-            edges->push_back(i);
+            int j = __builtin_ctzll(cut);
+            cuts[j]->mask[word] |= bit;
+            capacities[j] += capacity;
+            sizes[j]++;
         }
-        i++;
     }
 
-    int cut_size = edges->size();
-    if (cut_size <= 1)
+    for (int j = 0; j < count; j++)
     {
-        cut_computed->edges = nullptr;
-        cut_computed->is_valid = false;
-        cut_computed->count_size = 0;
+        cuts[j]->count_size = sizes[j];
+        cuts[j]->is_valid = sizes[j] > 1;
+        if (!cuts[j]->is_valid)
+            capacities[j] = -1;
     }
-    else
+}
+
+void network::buildIndex()
+{
+    int n = _countNode + 2;
+    int m = _topology.size();
+
+    _index.count_nodes = n;
+    _index.count_edges = m;
+    _index.tails.resize(m);
+    _index.heads.resize(m);
+    _index.edges.resize(m);
+    _index.out_offsets.assign(n + 1, 0);
+    _index.in_offsets.assign(n + 1, 0);
+    _index.out_edges.resize(m);
+    _index.in_edges.resize(m);
+
+    for (int i = 0; i < m; i++)
+    {
+        network_edgekey &key = _topology.getKey(i);
+        _index.tails[i] = GET_NODE_NORMAL_ID(key.id1);
+        _index.heads[i] = GET_NODE_NORMAL_ID(key.id2);
+        _index.edges[i] = &_topology.get(key);
+        _index.out_offsets[_index.tails[i] + 1]++;
+        _index.in_offsets[_index.heads[i] + 1]++;
+    }
+
+    for (int u = 0; u < n; u++)
+    {
+        _index.out_offsets[u + 1] += _index.out_offsets[u];
+        _index.in_offsets[u + 1] += _index.in_offsets[u];
+    }
+
+    vector<int> out_pos(_index.out_offsets.begin(), _index.out_offsets.end() - 1);
+    vector<int> in_pos(_index.in_offsets.begin(), _index.in_offsets.end() - 1);
+    for (int i = 0; i < m; i++)
     {
-        cut_computed->edges = &(edges->front());
-        cut_computed->count_size = cut_size;
-        cut_computed->is_valid = true;
+        _index.out_edges[out_pos[_index.tails[i]]++] = i;
+        _index.in_edges[in_pos[_index.heads[i]]++] = i;
     }
+
+    //archi uscenti ordinati per nodo di arrivo: findOutEdge e' una ricerca binaria anche sui nodi
+    //con migliaia di archi, e l'arco inverso si cerca una volta sola
+    for (int u = 0; u < n; u++)
+    {
+        sort(_index.out_edges.begin() + _index.out_offsets[u], _index.out_edges.begin() + _index.out_offsets[u + 1],
+             [&](int a, int b)
+             { return _index.heads[a] < _index.heads[b]; });
+    }
+    _index.reverse.resize(m);
+    for (int i = 0; i < m; i++)
+        _index.reverse[i] = _index.findOutEdge(_index.heads[i], _index.tails[i]);
 }
 
 #define GET_NODE_LINK(id) id >= 0 ? &target._nodes[id] : (id == ID_NODE_SOURCE ? &target._s : (id == ID_NODE_TARGET ? &target._t : throw "Id del nodo non valido"))
@@ -585,11 +899,10 @@ double network::computeCutCapacity(network_cut &cut)
     if (cut.is_valid)
     {
         double cut_capacity = 0;
-        for (int i = 0; i < cut.count_size; i++)
+        for (int w = 0; w < cut.count_words; w++)
         {
-            int &edge_key = cut.edges[i];
-            network_edge &edge = _topology.get(edge_key);
-            cut_capacity += edge.capacity;
+            for (uint64_t bits = cut.mask[w]; bits != 0; bits &= bits - 1)
+                cut_capacity += _index.edges[(w << 6) + __builtin_ctzll(bits)]->capacity;
         }
         return cut_capacity;
     }
@@ -929,6 +1242,8 @@ namespace graph
         }
 
         delete[] firstlayers;
+
+        net->buildIndex();
     }
 
     void buildNetwork(network *net, topology &elms)
@@ -982,6 +1297,8 @@ namespace graph
             nd2->prev.push_back(nd1);
             net->_topology.link(id1, id2, x.second.capacity);
         }
+
+        net->buildIndex();
     }
 
 }
\ No newline at end of file
@@ -74,6 +74,69 @@ namespace graph
 
     string to_string(const network_path &p);
 
+    string to_string(const int *path, int size);
+
+    //cammino memorizzato in un path_arena: posizione del primo nodo e numero di nodi
+    typedef struct s_path_span
+    {
+        int offset;
+        int size;
+    } path_span;
+
+    //buffer a crescita lineare per i cammini di un'iterazione. Gli span restano validi fino a reset()
+    //e la memoria viene riutilizzata: a regime l'arena non fa piu' allocazioni.
+    class path_arena
+    {
+    private:
+        vector<int> _buffer;
+        int _top = 0;
+
+    public:
+        inline void reset()
+        {
+            _top = 0;
+        }
+
+        inline int top() const
+        {
+            return _top;
+        }
+
+        inline void push(int id)
+        {
+            if (_top == (int)_buffer.size())
+                _buffer.resize(_buffer.empty() ? 256 : 2 * _buffer.size());
+            _buffer[_top++] = id;
+        }
+
+        inline void pop()
+        {
+            _top--;
+        }
+
+        inline int back() const
+        {
+            return _buffer[_top - 1];
+        }
+
+        //chiude il cammino iniziato alla posizione offset
+        inline path_span close(int offset) const
+        {
+            path_span span = {offset, _top - offset};
+            return span;
+        }
+
+        inline int *data(const path_span &span)
+        {
+            return _buffer.data() + span.offset;
+        }
+
+        inline bool isValid(const path_span &span) const
+        {
+            return span.size > 0 && IS_NODE_SOURCE(_buffer[span.offset]) && IS_NODE_TARGET(_buffer[span.offset + span.size - 1]);
+        }
+    };
+
     string to_hash(const network_path &p);
 
     struct network_path_compare
@@ -106,24 +169,53 @@ namespace graph
 
 #define IS_VALID_CUT_CAPACITY(cut_capacity) (cut_capacity >= 0)
 
+    //bit i di una bitmap di uint64_t, e parole necessarie per n bit
+#define BITMAP_WORD(i) ((i) >> 6)
+#define BITMAP_BIT(i) (1ULL << ((i) & 63))
+#define BITMAP_WORDS(n) (((n) + 63) >> 6)
+//partizioni valutate insieme da computeNetworkCuts, una per bit di uint64_t
+#define NETWORK_CUT_LANES 64
+
+    //archi del taglio come bitmap sugli indici della topologia, un bit per arco della rete.
+    //count_size sono gli archi nel taglio, che e' valido se ne ha almeno due. Con shared la bitmap
+    //appartiene a un'arena esterna: ha gia' la dimensione giusta e non viene liberata
     typedef struct s_network_cut
     {
-        int *edges;
-        bool is_valid;
+        uint64_t *mask;
+        int count_words;
         int count_size;
+        bool is_valid;
+        bool shared;
 
         s_network_cut();
         ~s_network_cut();
+
+        void attach(uint64_t *mask, int count_words);
+
+        //taglio vuoto su count_edges archi
+        void clear(int count_edges);
+
+        inline bool contains(int edge) const
+        {
+            return (mask[BITMAP_WORD(edge)] & BITMAP_BIT(edge)) != 0;
+        }
     } network_cut;
 
     string to_string(network_cut &cut);
     void copy(network_cut *source, network_cut *target);
 
+    //i primi size_S nodi sono il lato S, gli altri il lato T. sides e' la bitmap del lato S per id
+    //normale: sorgente e target non stanno in nessuno dei due lati, quindi i loro bit restano spenti.
+    //Chi modifica nodes o size_S deve chiamare updateSides(). Con shared i buffer appartengono a
+    //un'arena esterna
     typedef struct s_network_partition
     {
         int *nodes;
         int size_S;
         int size_T;
+        uint64_t *sides;
+        int count_words;
+        bool shared;
 
         s_network_partition();
         ~s_network_partition();
@@ -145,23 +237,130 @@ namespace graph
             return size_S;
         }
 
+        //u e' l'id normale
+        inline bool isSideS(int u) const
+        {
+            return (sides[BITMAP_WORD(u)] & BITMAP_BIT(u)) != 0;
+        }
+
         inline bool containsInS(int node)
         {
-            return core::exists<int>(nodes, 0, size_S, node);
+            return isSideS(GET_NODE_NORMAL_ID(node));
         }
 
-        bool containsInT(int node)
+        inline bool containsInT(int node)
         {
-            return core::exists<int>(nodes, size_S + 1, size_S + size_T, node);
+            return !IS_NODE_SOURCE(node) && !IS_NODE_TARGET(node) && !containsInS(node);
         }
 
+        void attach(int *nodes, int size_node, uint64_t *sides, int count_words);
+
         void copyFrom(int *nodes, int size_node, int splitter);
+
+        void updateSides();
     } network_partition;
 
     void copy(network_partition *source, network_partition *target);
 
+    //nodi del cammino corrente con la loro posizione, marcati con l'epoca del cammino: la verifica e'
+    //O(1) e per iniziare un nuovo cammino basta incrementare l'epoca, senza azzerare tutta la rete
+    class node_tabu
+    {
+    private:
+        vector<int> _stamps;
+        vector<int> _positions;
+        int _epoch = 0;
+
+    public:
+        inline void resize(int count_nodes)
+        {
+            _stamps.assign(count_nodes, 0);
+            _positions.assign(count_nodes, 0);
+            _epoch = 0;
+        }
+
+        inline void next()
+        {
+            _epoch++;
+        }
+
+        inline bool contains(int id) const
+        {
+            return _stamps[GET_NODE_NORMAL_ID(id)] == _epoch;
+        }
+
+        inline int position(int id) const
+        {
+            return _positions[GET_NODE_NORMAL_ID(id)];
+        }
+
+        inline void insert(int id, int position)
+        {
+            _stamps[GET_NODE_NORMAL_ID(id)] = _epoch;
+            _positions[GET_NODE_NORMAL_ID(id)] = position;
+        }
+
+        inline void remove(int id)
+        {
+            _stamps[GET_NODE_NORMAL_ID(id)] = 0;
+        }
+    };
+
     int shuffle_partition(network_partition *partition, double mutation_rate, double p_change_size, int min_partition_size, core::RandomNumberGenerator *random);
 
+    //la partizione prende il lato del partner sui nodi con il bit acceso in mask (per id normale):
+    //S diventa (S & ~mask) | (S del partner & mask), parola per parola. Ritorna i nodi che hanno
+    //cambiato lato, 0 se uno dei due lati scenderebbe sotto min_partition_size
+    int crossover_partition(network_partition *partition, network_partition *partner, const uint64_t *mask, int min_partition_size);
+
+    //indice denso della rete: i nodi sono numerati con GET_NODE_NORMAL_ID, gli archi con l'indice della topologia
+    typedef struct s_network_index
+    {
+        int count_nodes = 0;
+        int count_edges = 0;
+        vector<int> out_offsets;      //archi uscenti dal nodo u in [out_offsets[u], out_offsets[u + 1])
+        vector<int> out_edges;
+        vector<int> in_offsets;       //archi entranti nel nodo u in [in_offsets[u], in_offsets[u + 1])
+        vector<int> in_edges;
+        vector<int> tails;            //nodo di partenza dell'arco
+        vector<int> heads;            //nodo di arrivo dell'arco
+        vector<int> reverse;          //arco inverso head -> tail o -1
+        vector<network_edge *> edges; //arco della topologia
+
+        inline int outDegree(int u) const
+        {
+            return out_offsets[u + 1] - out_offsets[u];
+        }
+
+        inline int inDegree(int u) const
+        {
+            return in_offsets[u + 1] - in_offsets[u];
+        }
+
+        //indice dell'arco u -> v (id normali) o -1, ricerca binaria negli archi uscenti di u
+        //ordinati per nodo di arrivo
+        inline int findOutEdge(int u, int v) const
+        {
+            int low = out_offsets[u], high = out_offsets[u + 1];
+            while (low < high)
+            {
+                int middle = (low + high) >> 1;
+                if (heads[out_edges[middle]] < v)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low < out_offsets[u + 1] && heads[out_edges[low]] == v ? out_edges[low] : -1;
+        }
+
+        //arco del passo u -> v nel grafo residuo: u -> v se esiste, altrimenti v -> u, o -1
+        inline int findStep(int u, int v) const
+        {
+            int e = findOutEdge(u, v);
+            return e >= 0 ? e : findOutEdge(v, u);
+        }
+    } network_index;
+
     typedef struct
     {
         int countNode = 100;
@@ -181,6 +380,7 @@ namespace graph
         network_node _s, _t;
         int _countNode;
         core::RandomNumberGenerator *_random;
+        network_index _index;
 
     public:
         network(core::RandomNumberGenerator *rand);
@@ -205,6 +405,16 @@ namespace graph
             return _topology;
         }
 
+        inline network_index &getIndex()
+        {
+            return _index;
+        }
+
+        inline network_edge &getEdge(int index)
+        {
+            return *_index.edges[index];
+        }
+
         inline network_edge &getEdge(const network_edgekey &edge)
         {
             network_edge &e = _topology.get(edge);
@@ -231,14 +441,20 @@ namespace graph
 
         inline int pruning()
         {
-            return _topology.pruning(true, true);
+            int n = _topology.pruning(true, true);
+            buildIndex();
+            return n;
         }
 
         inline int fullconnected()
         {
-            return _topology.fullconnected({0.0, this->getFlowUpperbound()}, this->_random);
+            int n = _topology.fullconnected({0.0, this->getFlowUpperbound()}, this->_random);
+            buildIndex();
+            return n;
         }
 
+        void buildIndex();
+
         void populateNodeIds(int *v, int start, bool include_special_node);
 
         double getFlowUpperbound();
@@ -253,7 +469,138 @@ namespace graph
 
         void computeNetworkCut(network_partition *partition, network_cut *cut_computed);
 
-        network_path navigate(select_node_function select_node, void *arg, int max_size = -1);
+        //aggiorna il taglio dopo che la partizione e' cambiata guardando solo gli archi dei nodi che
+        //hanno cambiato lato rispetto a old_sides, la bitmap del lato S prima della modifica.
+        //capacity e' la capacita' del taglio prima della modifica e viene aggiornata arco per arco,
+        //-1 se il taglio non e' valido
+        void updateNetworkCut(network_partition *partition, const uint64_t *old_sides, network_cut *cut, double &capacity);
+
+        //valuta insieme fino a NETWORK_CUT_LANES partizioni: lanes[u] ha il bit j acceso se il nodo u
+        //(id normale) e' in S nella partizione j, quindi gli archi dei tagli si trovano con un solo
+        //passaggio sugli archi. Scrive i tagli e la loro capacita', -1 per quelli non validi.
+        //lanes e' un buffer del chiamante
+        void computeNetworkCuts(network_partition *const *partitions, network_cut *const *cuts, int count, double *capacities, vector<uint64_t> &lanes);
+
+        //con update_counter = false la rete non viene modificata e piu' formiche possono navigare in parallelo
+        network_path navigate(select_node_function select_node, void *arg, int max_size = -1, bool update_counter = true);
+
+        //come navigate ma il selettore e' un funtore, select(node, path) ritorna il nodo successivo o nullptr:
+        //la chiamata viene risolta a compile time e la scelta del passo puo' essere inlinata
+        template <typename Selector>
+        network_path navigate(Selector &select, int max_size = -1, bool update_counter = true)
+        {
+            network_path p = createPath();
+            network_node *current_node = GET_NODE_SOURCE(this);
+            p->push_back(current_node->id);
+
+            int count = 0;
+            network_node *last_node;
+            while (!IS_NODE_TARGET(current_node->id) && (max_size <= 0 || count <= max_size))
+            {
+                last_node = current_node;
+                current_node = select(current_node, p);
+                if (current_node == nullptr)
+                {
+                    break;
+                }
+
+                if (update_counter)
+                {
+                    network_edge &edge = getEdge({last_node->id, current_node->id});
+                    edge.counter++;
+                }
+                p->push_back(current_node->id);
+
+                count++;
+            }
+
+            return p;
+        }
+
+        //navigate che scrive il cammino in un path_arena, select(node, size) riceve la lunghezza corrente
+        template <typename Selector>
+        path_span navigate(Selector &select, path_arena &arena, int max_size = -1, bool update_counter = true)
+        {
+            int offset = arena.top();
+            network_node *current_node = GET_NODE_SOURCE(this);
+            arena.push(current_node->id);
+
+            int count = 0;
+            network_node *last_node;
+            while (!IS_NODE_TARGET(current_node->id) && (max_size <= 0 || count <= max_size))
+            {
+                last_node = current_node;
+                current_node = select(current_node, count + 1);
+                if (current_node == nullptr)
+                {
+                    break;
+                }
+
+                if (update_counter)
+                {
+                    network_edge &edge = getEdge({last_node->id, current_node->id});
+                    edge.counter++;
+                }
+                arena.push(current_node->id);
+
+                count++;
+            }
+
+            return arena.close(offset);
+        }
+
+        //come la versione con arena ma i cicli vengono rimossi durante la navigazione: tornando su un
+        //nodo del cammino si tolgono i nodi successivi, quindi il cammino restituito e' semplice.
+        //max_size limita i nodi del cammino e max_erased i nodi tolti in tutto: ogni passo aggiunge
+        //o toglie nodi, quindi la navigazione fa O(max_size + max_erased) passi
+        template <typename Selector>
+        path_span navigate(Selector &select, path_arena &arena, node_tabu &tabu, int max_size = -1, int max_erased = -1, bool update_counter = true)
+        {
+            int offset = arena.top();
+            network_node *current_node = GET_NODE_SOURCE(this);
+            tabu.next();
+            tabu.insert(current_node->id, 0);
+            arena.push(current_node->id);
+
+            int erased = 0;
+            network_node *last_node;
+            while (!IS_NODE_TARGET(current_node->id) && (max_size <= 0 || arena.top() - offset < max_size))
+            {
+                last_node = current_node;
+                current_node = select(current_node, arena.top() - offset);
+                if (current_node == nullptr)
+                {
+                    break;
+                }
+
+                if (update_counter)
+                {
+                    network_edge &edge = getEdge({last_node->id, current_node->id});
+                    edge.counter++;
+                }
+
+                if (tabu.contains(current_node->id))
+                {
+                    int position = offset + tabu.position(current_node->id);
+                    while (arena.top() - 1 > position)
+                    {
+                        tabu.remove(arena.back());
+                        arena.pop();
+                        erased++;
+                    }
+                    //oltre il limite il cammino resta aperto e non arriva al target
+                    if (max_erased >= 0 && erased > max_erased)
+                        break;
+                }
+                else
+                {
+                    tabu.insert(current_node->id, arena.top() - offset);
+                    arena.push(current_node->id);
+                }
+            }
+
+            return arena.close(offset);
+        }
 
         int countEdges(network_path path);
 
@@ -261,14 +608,38 @@ namespace graph
 
         int edges(network_path path, vector<network_edgekey> &edges);
 
+        //capacita' residua del passo u -> v: residuo dell'arco u -> v piu' il flusso annullabile su v -> u
+        double getResidualCapacity(int u, int v);
+
+        //come sopra per il passo sull'arco e, nel suo verso se forward, altrimenti all'indietro
+        double getArcResidualCapacity(int e, bool forward);
+
+        //aggiunge delta_flow al passo u -> v annullando prima il flusso sull'arco v -> u
+        void pushFlow(int u, int v, double delta_flow);
+
+        void pushArcFlow(int e, bool forward, double delta_flow);
+
+        //i cammini possono contenere archi inversi del grafo residuo
         double getMinResidualCapacity(network_path path);
 
+        double getMinResidualCapacity(const int *path, int size);
+
+        //arcs[i] e' l'arco del passo path[i] -> path[i + 1] trovato con findStep
+        double getMinResidualCapacity(const int *path, const int *arcs, int size);
+
         void updateFlow(network_path path, double delta_flow);
 
+        void updateFlow(const int *path, int size, double delta_flow);
+
+        void updateFlow(const int *path, const int *arcs, int size, double delta_flow);
+
         //void updateAllEdges(network_path path, double delta_flow_path, double delta_tau_path, double delta_flow, double delta_tau);
 
         network_path normalizePath(network_path path);
 
+        //rimuove i cicli dal cammino scrivendo il risultato in arena
+        path_span normalizePath(const int *path, int size, path_arena &arena);
+
         void reset(bool flow = true, bool capacity = true, bool status = true, bool color = true, bool heuristic = true, double default_tau = 1);
 
         void enableAllEdges();
@@ -0,0 +1,448 @@
+#include "reduction.h"
+
+using namespace graph;
+using namespace core;
+
+topology_reduction::topology_reduction()
+{
+    _original_nodes = 0;
+    _original_edges = 0;
+    _contracted_nodes = 0;
+}
+
+topology_reduction::~topology_reduction()
+{
+    clear();
+}
+
+void topology_reduction::clear()
+{
+    _reduced.clear();
+    _node_ids.clear();
+    _edge_keys.clear();
+    _records.clear();
+    _origins.clear();
+    _original_nodes = 0;
+    _original_edges = 0;
+    _contracted_nodes = 0;
+}
+
+void visitReachable(int start, int stop, vector<vector<int>> &adj, vector<int> &ends, vector<double> &capacities, vector<bool> &visited)
+{
+    queue<int> q;
+    q.push(start);
+    visited[start] = true;
+    while (!q.empty())
+    {
+        int u = q.front();
+        q.pop();
+        if (u == stop)
+            continue;
+        for (auto &&e : adj[u])
+        {
+            int v = ends[e];
+            if (!visited[v] && capacities[e] > 0)
+            {
+                visited[v] = true;
+                q.push(v);
+            }
+        }
+    }
+}
+
+int topology_reduction::reduce(topology &source, reduction_option &option)
+{
+    clear();
+
+    //indicizza i nodi in ordine crescente di id, source e target occupano le prime due posizioni
+    vector<int> ids;
+    for (auto &&e : source)
+    {
+        ids.push_back(e.first.id1);
+        ids.push_back(e.first.id2);
+    }
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+
+    if (ids.size() < 2 || !IS_NODE_SOURCE(ids[0]) || !IS_NODE_TARGET(ids[1]))
+        throw "La topologia non contiene source e target";
+
+    int n = ids.size();
+    unordered_map<int, int> positions;
+    for (int i = 0; i < n; i++)
+        positions.insert({ids[i], i});
+
+    int m = source.size();
+    vector<int> tails(m), heads(m);
+    vector<double> capacities(m);
+    vector<vector<int>> out(n), in(n);
+
+    int k = 0;
+    for (auto &&e : source)
+    {
+        tails[k] = positions[e.first.id1];
+        heads[k] = positions[e.first.id2];
+        capacities[k] = e.second.capacity;
+        out[tails[k]].push_back(k);
+        in[heads[k]].push_back(k);
+
+        _edge_keys.push_back(e.first);
+        _records.push_back({REDUCTION_EDGE_ORIGINAL, -1, -1, e.second.capacity});
+        k++;
+    }
+
+    //un nodo e' utile solo se e' raggiungibile da s e se da esso si raggiunge t senza ripassare da s o t
+    vector<bool> keep(n, true);
+    if (option.remove_unreachable)
+    {
+        vector<bool> forward(n, false), backward(n, false);
+        visitReachable(0, 1, out, heads, capacities, forward);
+        visitReachable(1, 0, in, tails, capacities, backward);
+
+        if (!forward[1])
+            throw "Il target non e' raggiungibile dalla source";
+
+        for (int i = 0; i < n; i++)
+            keep[i] = forward[i] && backward[i];
+    }
+
+    vector<bool> alive(m);
+    for (int e = 0; e < m; e++)
+    {
+        int u = tails[e], v = heads[e];
+        alive[e] = keep[u] && keep[v];
+        if (option.remove_unreachable && (u == v || capacities[e] <= 0 || v == 0 || u == 1))
+            alive[e] = false;
+    }
+
+    if (option.series_parallel)
+        _contracted_nodes = contract(n, tails, heads, alive);
+
+    //assegna gli id compatti rispettando l'ordine originale
+    int count_records = _records.size();
+    vector<bool> used(n, false);
+    for (int e = 0; e < count_records; e++)
+    {
+        if (alive[e])
+        {
+            used[tails[e]] = true;
+            used[heads[e]] = true;
+        }
+    }
+
+    if (!used[0] || !used[1])
+        throw "Il target non e' raggiungibile dalla source";
+
+    vector<int> reduced_ids(n);
+    reduced_ids[0] = ID_NODE_SOURCE;
+    reduced_ids[1] = ID_NODE_TARGET;
+    for (int i = 2; i < n; i++)
+    {
+        if (used[i])
+        {
+            reduced_ids[i] = _node_ids.size();
+            _node_ids.push_back(ids[i]);
+        }
+    }
+
+    for (int e = 0; e < count_records; e++)
+    {
+        if (alive[e])
+        {
+            network_edgekey key(reduced_ids[tails[e]], reduced_ids[heads[e]]);
+            _reduced.link(key.id1, key.id2, _records[e].capacity);
+            _origins[key] = e;
+        }
+    }
+
+    _original_nodes = n - 2;
+    _original_edges = m;
+    return m - _reduced.size();
+}
+
+typedef struct s_reduction_graph
+{
+    vector<unordered_map<int, int>> out; //nodo successivo -> record
+    vector<unordered_map<int, int>> in;  //nodo precedente -> record
+
+    inline s_reduction_graph(int count_nodes) : out(count_nodes), in(count_nodes) {}
+
+    inline void link(int e, int u, int v)
+    {
+        out[u][v] = e;
+        in[v][u] = e;
+    }
+
+    inline void unlink(int u, int v)
+    {
+        out[u].erase(v);
+        in[v].erase(u);
+    }
+
+    inline int find(int u, int v)
+    {
+        auto it = out[u].find(v);
+        return it != out[u].end() ? it->second : -1;
+    }
+} reduction_graph;
+
+int topology_reduction::contract(int count_nodes, vector<int> &tails, vector<int> &heads, vector<bool> &alive)
+{
+    reduction_graph g(count_nodes);
+    int m = _records.size();
+    for (int e = 0; e < m; e++)
+    {
+        if (!alive[e])
+            continue;
+        //i cappi non portano flusso
+        if (tails[e] == heads[e])
+            alive[e] = false;
+        else
+            g.link(e, tails[e], heads[e]);
+    }
+
+    queue<int> work;
+    vector<bool> queued(count_nodes, false), removed(count_nodes, false);
+    for (int v = 2; v < count_nodes; v++)
+    {
+        work.push(v);
+        queued[v] = true;
+    }
+
+    int contracted = 0;
+    while (!work.empty())
+    {
+        int v = work.front();
+        work.pop();
+        queued[v] = false;
+        if (removed[v])
+            continue;
+
+        unordered_map<int, int> &out = g.out[v];
+        unordered_map<int, int> &in = g.in[v];
+
+        //solo i nodi pendenti o di grado due sono contraibili, il controllo resta O(1)
+        int neighbors[2], count_neighbors = 0;
+        bool dangling = out.empty() || in.empty();
+        if (!dangling)
+        {
+            if (out.size() > 2 || in.size() > 2)
+                continue;
+
+            for (int pass = 0; pass < 2 && count_neighbors <= 2; pass++)
+            {
+                for (auto &&item : (pass == 0 ? in : out))
+                {
+                    int x = item.first;
+                    if (count_neighbors > 0 && neighbors[0] == x)
+                        continue;
+                    if (count_neighbors > 1 && neighbors[1] == x)
+                        continue;
+                    if (count_neighbors == 2)
+                    {
+                        count_neighbors++;
+                        break;
+                    }
+                    neighbors[count_neighbors++] = x;
+                }
+            }
+            if (count_neighbors > 2)
+                continue;
+        }
+
+        int uv = -1, vw = -1, wv = -1, vu = -1;
+        int u = -1, w = -1;
+        if (!dangling && count_neighbors == 2)
+        {
+            u = neighbors[0];
+            w = neighbors[1];
+            uv = g.find(u, v);
+            vw = g.find(v, w);
+            wv = g.find(w, v);
+            vu = g.find(v, u);
+        }
+
+        //rimuove v: un nodo pendente o collegato a un solo vicino porta al piu' flusso ciclico
+        vector<int> touched;
+        for (auto &&item : out)
+        {
+            alive[item.second] = false;
+            g.in[item.first].erase(v);
+            touched.push_back(item.first);
+        }
+        for (auto &&item : in)
+        {
+            alive[item.second] = false;
+            g.out[item.first].erase(v);
+            touched.push_back(item.first);
+        }
+        out.clear();
+        in.clear();
+        removed[v] = true;
+        contracted++;
+
+        //serie: u->v->w diventa u->w con la capacita' minima, in parallelo a un eventuale u->w esistente
+        int pairs[2][4] = {{u, w, uv, vw}, {w, u, wv, vu}};
+        for (int p = 0; p < 2; p++)
+        {
+            int a = pairs[p][0], b = pairs[p][1], e1 = pairs[p][2], e2 = pairs[p][3];
+            if (e1 < 0 || e2 < 0)
+                continue;
+
+            int series = _records.size();
+            _records.push_back({REDUCTION_EDGE_SERIES, e1, e2, MIN(_records[e1].capacity, _records[e2].capacity)});
+            tails.push_back(a);
+            heads.push_back(b);
+            alive.push_back(true);
+
+            int existing = g.find(a, b);
+            if (existing >= 0)
+            {
+                alive[existing] = false;
+                alive[series] = false;
+
+                int parallel = _records.size();
+                _records.push_back({REDUCTION_EDGE_PARALLEL, existing, series, _records[existing].capacity + _records[series].capacity});
+                tails.push_back(a);
+                heads.push_back(b);
+                alive.push_back(true);
+                g.link(parallel, a, b);
+            }
+            else
+            {
+                g.link(series, a, b);
+            }
+        }
+
+        for (auto &&x : touched)
+        {
+            if (x >= 2 && !removed[x] && !queued[x])
+            {
+                work.push(x);
+                queued[x] = true;
+            }
+        }
+    }
+    return contracted;
+}
+
+void topology_reduction::restoreFlows(topology &solved, topology &original)
+{
+    for (auto &&e : original)
+        e.second.flow = 0;
+
+    int n = _records.size();
+    vector<double> flows(n, 0.0);
+    for (auto &&e : solved)
+        flows[_origins.at(e.first)] = e.second.flow;
+
+    //espande il log all'indietro: in serie il flusso passa su entrambi gli archi, in parallelo riempie prima il sinistro
+    for (int i = n - 1; i >= 0; i--)
+    {
+        reduction_record &record = _records[i];
+        double f = flows[i];
+        if (record.type == REDUCTION_EDGE_SERIES)
+        {
+            flows[record.left] += f;
+            flows[record.right] += f;
+        }
+        else if (record.type == REDUCTION_EDGE_PARALLEL)
+        {
+            double left = MIN(f, _records[record.left].capacity);
+            flows[record.left] += left;
+            flows[record.right] += f - left;
+        }
+        else if (f != 0)
+        {
+            original.get(_edge_keys[i]).flow = f;
+        }
+    }
+}
+
+int topology_reduction::restoreEdge(const network_edgekey &key, vector<network_edgekey> &edges)
+{
+    //un arco del taglio corrisponde al collo di bottiglia di una serie e a tutti i rami di un parallelo
+    int count = 0;
+    vector<int> stack;
+    stack.push_back(_origins.at(key));
+    while (!stack.empty())
+    {
+        int i = stack.back();
+        stack.pop_back();
+
+        reduction_record &record = _records[i];
+        if (record.type == REDUCTION_EDGE_SERIES)
+        {
+            bool left = _records[record.left].capacity <= _records[record.right].capacity;
+            stack.push_back(left ? record.left : record.right);
+        }
+        else if (record.type == REDUCTION_EDGE_PARALLEL)
+        {
+            stack.push_back(record.left);
+            stack.push_back(record.right);
+        }
+        else
+        {
+            edges.push_back(_edge_keys[i]);
+            count++;
+        }
+    }
+    return count;
+}
+
+int topology_reduction::restorePath(const int *path, int size, vector<int> &nodes)
+{
+    if (path == nullptr || size == 0)
+        return 0;
+
+    //un arco in serie si attraversa per intero, di un parallelo basta il ramo piu' capiente.
+    //Con il grafo residuo un passo puo' percorrere l'arco ridotto all'indietro
+    nodes.push_back(getOriginalNode(path[0]));
+    vector<pair<int, bool>> stack;
+    for (int i = 1; i < size; i++)
+    {
+        network_edgekey key(path[i - 1], path[i]);
+        auto it = _origins.find(key);
+        bool backward = it == _origins.end();
+        if (backward)
+            it = _origins.find(network_edgekey(path[i], path[i - 1]));
+        if (it == _origins.end())
+            throw "Il cammino non appartiene alla topologia ridotta";
+
+        stack.push_back({it->second, backward});
+        while (!stack.empty())
+        {
+            int e = stack.back().first;
+            bool reverse = stack.back().second;
+            stack.pop_back();
+
+            reduction_record &record = _records[e];
+            if (record.type == REDUCTION_EDGE_SERIES)
+            {
+                stack.push_back({reverse ? record.left : record.right, reverse});
+                stack.push_back({reverse ? record.right : record.left, reverse});
+            }
+            else if (record.type == REDUCTION_EDGE_PARALLEL)
+            {
+                bool left = _records[record.left].capacity >= _records[record.right].capacity;
+                stack.push_back({left ? record.left : record.right, reverse});
+            }
+            else
+            {
+                nodes.push_back(reverse ? _edge_keys[e].id1 : _edge_keys[e].id2);
+            }
+        }
+    }
+    return nodes.size();
+}
+
+string topology_reduction::print()
+{
+    stringstream ss;
+    ss << "REDUCTION" << endl
+       << "Nodes: " << _original_nodes << " -> " << countNodes() << endl
+       << "Edges: " << _original_edges << " -> " << countEdges() << endl
+       << "Contracted nodes: " << _contracted_nodes << endl
+       << "Reduction ratio: " << to_string_format(getReductionRatio()) << endl;
+    return ss.str();
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef _H_REDUCTION
+#define _H_REDUCTION
+
+#include "topology.h"
+
+namespace graph
+{
+    typedef struct
+    {
+        bool remove_unreachable = false;
+        bool series_parallel = false;
+
+    } reduction_option;
+
+    enum reduction_record_type
+    {
+        REDUCTION_EDGE_ORIGINAL = 0,
+        REDUCTION_EDGE_SERIES = 1,
+        REDUCTION_EDGE_PARALLEL = 2
+    };
+
+    //voce del log di espansione: un arco originale oppure la contrazione di due archi precedenti
+    typedef struct
+    {
+        reduction_record_type type;
+        int left;
+        int right;
+        double capacity;
+
+    } reduction_record;
+
+    class topology_reduction
+    {
+    private:
+        topology _reduced;
+        vector<int> _node_ids;                //id del nodo ridotto -> id del nodo originale
+        vector<network_edgekey> _edge_keys;   //record originale -> arco originale
+        vector<reduction_record> _records;    //log di espansione, i figli precedono sempre i padri
+        unordered_map<network_edgekey, int, network_edgekey_hasher> _origins; //arco ridotto -> record
+        int _original_nodes;
+        int _original_edges;
+        int _contracted_nodes;
+
+    public:
+        topology_reduction();
+        ~topology_reduction();
+
+        inline topology &getTopology()
+        {
+            return _reduced;
+        }
+
+        inline int countNodes()
+        {
+            return _node_ids.size();
+        }
+
+        inline int countEdges()
+        {
+            return _reduced.size();
+        }
+
+        inline int getOriginalNode(int id)
+        {
+            return IS_DEFAULT_NODE(id) ? id : _node_ids.at(id);
+        }
+
+        //frazione di archi rimossi rispetto alla topologia originale
+        inline double getReductionRatio()
+        {
+            return _original_edges > 0 ? 1.0 - ((double)_reduced.size() / (double)_original_edges) : 0.0;
+        }
+
+        int reduce(topology &source, reduction_option &option);
+
+        void restoreFlows(topology &solved, topology &original);
+
+        //archi originali che formano il taglio dell'arco ridotto key
+        int restoreEdge(const network_edgekey &key, vector<network_edgekey> &edges);
+
+        //nodi originali del cammino di id ridotti path
+        int restorePath(const int *path, int size, vector<int> &nodes);
+
+        void clear();
+
+        string print();
+
+    private:
+        int contract(int count_nodes, vector<int> &tails, vector<int> &heads, vector<bool> &alive);
+    };
+}
+#endif
@@ -20,6 +20,20 @@ string to_string(network_edgekey &key)
     return ss.str();
 }
 
+string graph::to_string(vector<network_edgekey> &edges)
+{
+    stringstream ss;
+    ss << "(";
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        if (i > 0)
+            ss << ",";
+        ss << to_string_format(edges[i].id1) << "->" << to_string_format(edges[i].id2);
+    }
+    ss << ")";
+    return ss.str();
+}
+
 topology::topology()
 {
 }
@@ -64,9 +78,12 @@ int topology::size(bool only_enable, bool only_internal) const
 
 int topology::fullconnected(rangedouble capacity_range, RandomNumberGenerator *rdn)
 {
+    //link aggiunge in fondo a _keys: si scorrono solo le chiavi iniziali, per copia
     int inserted = 0;
-    for (auto &&key : _keys)
+    int count_keys = _keys.size();
+    for (int i = 0; i < count_keys; i++)
     {
+        network_edgekey key = _keys[i];
         if (link(key.id2, key.id1, rdn->getDouble(capacity_range), false))
             inserted++;
     }
@@ -84,6 +84,7 @@ namespace graph
 
 	} network_edgekey;
 	string to_string(network_edgekey &key);
+	string to_string(vector<network_edgekey> &edges);
 
 	struct network_edgekey_hasher
 	{